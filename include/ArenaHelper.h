@@ -0,0 +1,69 @@
+/**
+ * @file ArenaHelper.h
+ * @author Kevin ioi
+ * @date Oct 2018
+ * @brief File containing the functions needed to allocate a whole card from one region
+ */
+
+#ifndef _ARENAHELPER_H
+#define  _ARENAHELPER_H
+
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "LinkedListAPI.h"
+
+/*
+  One malloc'd piece of an arena, handed out front to back
+*/
+typedef struct arenaBlock {
+  struct arenaBlock *next;
+
+  //bytes of data handed out so far, and bytes available
+  size_t            used;
+  size_t            size;
+
+  max_align_t       data[];
+} ArenaBlock;
+
+/*
+  Something malloc'd that was given to an arena card, deleted when the arena is freed
+*/
+typedef struct arenaCleanup {
+  struct arenaCleanup *next;
+  void                *data;
+  void                (*deleteData)(void *toBeDeleted);
+} ArenaCleanup;
+
+/*
+  Bump allocated region holding everything reachable from one card, see createCardInArena().
+  Nothing in it is freed on its own, freeArena() releases all of it at once
+*/
+typedef struct cardArena {
+  //newest block first, allocations come from the head
+  ArenaBlock    *blocks;
+
+  ArenaCleanup  *cleanups;
+} CardArena;
+
+CardArena *newArena(void);
+
+void *arenaAlloc(void *arena, size_t size);
+
+bool arenaAdopt(CardArena *arena, void *data, void (*deleteData)(void *toBeDeleted));
+
+void freeArena(CardArena *arena);
+
+void *allocFrom(CardArena *arena, size_t size);
+
+char *copySliceFrom(CardArena *arena, const char *slice, size_t length);
+
+List *listFrom(CardArena *arena, char* (*printFunction)(void* toBePrinted),void (*deleteFunction)(void* toBeDeleted),int (*compareFunction)(const void* first,const void* second));
+
+List *arrayListFrom(CardArena *arena, char* (*printFunction)(void* toBePrinted),void (*deleteFunction)(void* toBeDeleted),int (*compareFunction)(const void* first,const void* second));
+
+void discardFrom(CardArena *arena, void *data, void (*deleteData)(void *toBeDeleted));
+
+#endif
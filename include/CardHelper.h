@@ -5,11 +5,71 @@
  * @brief File containing the functions needed to
  */
 
+#ifndef _CARDHELPER_H
+#define  _CARDHELPER_H
+
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 #include "LinkedListAPI.h"
 #include "PropertyHelper.h"
+#include "ParseHelper.h"
+#include "ValidationHelper.h"
+
+/*
+  What initializeCard and initializeArenaCard actually allocate. The card comes first so a
+  Card pointer is also a pointer to its record, and the card's own list points back at it
+  through owner, which is how cardRecord() tells a record apart from a hand built Card
+*/
+typedef struct cardRecord {
+  Card        card;
+
+  //the arena everything in the card lives in, NULL for a malloc card
+  CardArena   *arena;
+
+  //what validateCard would find in optionalProperties, see appendProperty()
+  CardValidation validation;
+} CardRecord;
+
+//which content line a CardBuilder is waiting for
+typedef enum buildStage { EXPECT_BEGIN, EXPECT_VERSION, EXPECT_PROPERTY } BuildStage;
+
+/*
+  A card being put together one content line at a time, see addCardLine()
+*/
+typedef struct cardBuilder {
+  //the card so far, NULL until its BEGIN:VCARD line has been seen
+  Card        *card;
+
+  BuildStage  stage;
+
+  //build each card in an arena of its own
+  bool        useArena;
+} CardBuilder;
 
 Card *initializeCard(char* (*printProp)(void* toBePrinted),void (*deleteProp)(void* toBeDeleted),int (*compareProp)(const void* first,const void* second));
+
+Card *initializeArenaCard(void);
+
+CardRecord *cardRecord(const Card *card);
+
+CardArena *cardArena(const Card *card);
+
+VCardErrorCode parseCard(const char *vCardString, size_t maxIndex, size_t *lineIndex, bool useArena, Card **newCardObject);
+
+size_t findNextCard(const char *vCardString, size_t maxIndex, size_t from);
+
+size_t skipBlankLines(const char *vCardString, size_t maxIndex, size_t from);
+
+size_t skipBrokenCard(const char *vCardString, size_t maxIndex, size_t cardStart, size_t lineIndex);
+
+bool beginsCard(const ContentLine *contentLine);
+
+void startCardBuilder(CardBuilder *builder, bool useArena);
+
+void clearCardBuilder(CardBuilder *builder);
+
+VCardErrorCode addCardLine(CardBuilder *builder, ContentLine *contentLine, Card **finishedCard);
+
+#endif
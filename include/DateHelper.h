@@ -14,9 +14,12 @@
 
 #include "LinkedListAPI.h"
 #include "VCardParser.h"
+#include "ParseHelper.h"
 
 
-VCardErrorCode newDate(DateTime **date, char **contentLine);
+VCardErrorCode scanDate(ContentLine *contentLine, DateTime *fixed, size_t *textStart, size_t *textLength);
+
+VCardErrorCode newDate(DateTime **date, ContentLine *contentLine, CardArena *arena);
 
 
 
@@ -0,0 +1,59 @@
+/**
+ * @file FileHelper.h
+ * @author Kevin ioi
+ * @date Sept 2018
+ * @brief File containing the functions needed to map a vcf file in to memory
+ */
+
+#ifndef _FILEHELPER_H
+#define  _FILEHELPER_H
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "VCardParser.h"
+
+/*
+  Read-only view of an entire vcf file.
+  The bytes are NOT null terminated, always use length.
+*/
+typedef struct vCardBuffer {
+  //file contents, either a mmap'd region or a single heap block
+  const char  *data;
+
+  //number of bytes in data
+  size_t      length;
+
+  //true if data must be released with munmap, false if with free
+  bool        mapped;
+
+  //true if data belongs to the caller and must not be released at all
+  bool        borrowed;
+} VCardBuffer;
+
+/*
+  Cursor over a multi-card vcf file, see openCardStream()
+*/
+struct cardStream {
+  //the whole file, mapped read-only
+  VCardBuffer file;
+
+  //index of the first content line of the next card
+  size_t      lineIndex;
+
+  //cards are built in an arena each, see setCardStreamArena()
+  bool        useArena;
+};
+
+bool validFileExtension(const char *fileName);
+
+VCardErrorCode mapVCardFile(const char *fileName, VCardBuffer *buffer);
+
+VCardErrorCode readVCardFd(int fd, VCardBuffer *buffer);
+
+void unmapVCardFile(VCardBuffer *buffer);
+
+void borrowVCardBuffer(const char *data, size_t length, VCardBuffer *buffer);
+
+#endif
@@ -0,0 +1,30 @@
+/**
+ * @file InternHelper.h
+ * @author Kevin ioi
+ * @date Oct 2018
+ * @brief File containing the functions needed to share one copy of each property, group
+ *        and parameter name between every card in the process
+ */
+
+#ifndef _INTERNHELPER_H
+#define  _INTERNHELPER_H
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "VCardParser.h"
+#include "ArenaHelper.h"
+
+//names this long or longer are never interned, they get a copy of their own
+#define INTERN_MAX_LENGTH 200
+
+const char *internSlice(const char *slice, size_t length);
+
+bool isInterned(const char *string);
+
+char *internOrCopy(CardArena *arena, const char *slice, size_t length);
+
+void freeName(void *name);
+
+#endif
@@ -0,0 +1,34 @@
+/**
+ * @file JSONHelper.h
+ * @author Kevin ioi
+ * @date Oct 2018
+ * @brief File containing the functions needed to write strings, properties, dates and whole
+ *        cards out as JSON in to an OutBuffer, and a card stream out as NDJSON
+ */
+
+#ifndef _JSONHELPER_H
+#define  _JSONHELPER_H
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "VCardParser.h"
+#include "LinkedListAPI.h"
+#include "WriteCardHelper.h"
+
+bool appendJSONString(OutBuffer *out, const char *string);
+
+bool appendJSONStrList(OutBuffer *out, const List *strList);
+
+bool appendJSONProperty(OutBuffer *out, const Property *prop, bool withParameters);
+
+bool appendJSONDateTime(OutBuffer *out, const DateTime *date);
+
+bool appendJSONCard(OutBuffer *out, const Card *card);
+
+char *finishJSON(OutBuffer *out);
+
+VCardErrorCode writeNDJSON(int fd, CardStream *stream);
+
+#endif
@@ -0,0 +1,78 @@
+/**
+ * @file JSONParseHelper.h
+ * @author Kevin ioi
+ * @date Oct 2018
+ * @brief File containing the functions needed to tokenize JSON text and read strings,
+ *        properties, dates and whole cards back out of it
+ */
+
+#ifndef _JSONPARSEHELPER_H
+#define  _JSONPARSEHELPER_H
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "VCardParser.h"
+#include "LinkedListAPI.h"
+
+typedef enum jsonTokenType {
+  JSON_BAD, JSON_END, JSON_OBJECT, JSON_OBJECT_END, JSON_ARRAY, JSON_ARRAY_END,
+  JSON_STRING, JSON_NUMBER, JSON_TRUE, JSON_FALSE, JSON_NULL, JSON_COLON, JSON_COMMA
+} JSONTokenType;
+
+/*
+  One token, pointing in to the text it came from
+*/
+typedef struct jsonToken {
+  JSONTokenType type;
+
+  //strings: the bytes between the quotes, escapes still in. numbers: the whole number
+  const char    *start;
+  size_t        length;
+
+  //string has at least one backslash escape, so it can't be used as is
+  bool          escaped;
+} JSONToken;
+
+/*
+  Cursor over JSON text, tokens are read from it one at a time
+*/
+typedef struct jsonReader {
+  const char  *text;
+  size_t      length;
+
+  //index of the first char not tokenized yet
+  size_t      index;
+} JSONReader;
+
+//what nextJSONMember/nextJSONElement found
+typedef enum jsonItem { JSON_ITEM, JSON_DONE, JSON_INVALID } JSONItem;
+
+void startJSONReader(JSONReader *reader, const char *text, size_t length);
+
+bool nextJSONToken(JSONReader *reader, JSONToken *token);
+
+bool atJSONEnd(JSONReader *reader);
+
+JSONItem nextJSONMember(JSONReader *reader, bool *first, JSONToken *key, JSONToken *value);
+
+JSONItem nextJSONElement(JSONReader *reader, bool *first, JSONToken *value);
+
+bool skipJSONValue(JSONReader *reader, const JSONToken *first);
+
+bool jsonStringIs(const JSONToken *token, const char *literal);
+
+char *copyJSONString(const JSONToken *token);
+
+bool readJSONStrList(JSONReader *reader, const JSONToken *first, List *strList);
+
+bool readJSONProperty(JSONReader *reader, const JSONToken *first, Property **newProp);
+
+bool readJSONDateTime(JSONReader *reader, const JSONToken *first, DateTime **newDate);
+
+bool readJSONCard(JSONReader *reader, const JSONToken *first, Card **newCard);
+
+bool readJSONFN(JSONReader *reader, const JSONToken *first, Card **newCard);
+
+#endif
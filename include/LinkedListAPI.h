@@ -37,6 +37,24 @@ typedef struct listHead{
     void (*deleteData)(void* toBeDeleted);
     int (*compare)(const void* first,const void* second);
     char* (*printData)(void* toBePrinted);
+    //where the head and nodes come from, NULL for malloc. Memory from an allocator is never
+    //freed by the list, it belongs to pool
+    void* (*allocate)(void* pool, size_t size);
+    void* pool;
+    //bumped every time a node is added or removed, so a caller can tell the list was edited
+    unsigned long changes;
+    //nodes of a malloc list are carved out of slabs, newest first, and removed nodes wait
+    //on freeNodes to be reused. All of it is released at once by clearList/freeList
+    struct nodeSlab* slabs;
+    Node* freeNodes;
+    //an array list keeps its data in order in elements, capacity slots long, and has no
+    //nodes at all, head and tail stay NULL. Walk any list with createIterator/nextElement
+    //rather than head and next, so it works either way. See initializeArrayList
+    bool contiguous;
+    void** elements;
+    int capacity;
+    //whoever the list belongs to, NULL unless they set it. The list never reads it
+    void* owner;
 } List;
 
 
@@ -47,6 +65,11 @@ typedef struct listHead{
  **/
 typedef struct iter{
     Node* current;
+    //an array list is walked by position instead, list is NULL for a linked list
+    List* list;
+    int index;
+    //nextElement returned an element that removeAt can take out
+    bool removable;
 } ListIterator;
 
 
@@ -63,6 +86,50 @@ typedef struct iter{
 List* initializeList(char* (*printFunction)(void* toBePrinted),void (*deleteFunction)(void* toBeDeleted),int (*compareFunction)(const void* first,const void* second));
 
 
+/** Function to initialize a list whose head and nodes are allocated from a pool instead of malloc.
+* Works exactly like initializeList, except freeList and removing elements never free list memory,
+* it is released with the pool
+*@pre allocate and the function pointer arguments must not be NULL
+*@post List structure has been allocated from pool and initialized
+*@return On success returns the new List struct. Returns NULL if allocate fails
+*@param allocate - returns size bytes from pool, or NULL
+*@param pool - passed to allocate unchanged
+*@param printFunction - function pointer to print a single node of the list
+*@param deleteFunction - function pointer to delete a single piece of data from the list
+*@param compareFunction - function pointer to compare two nodes of the list in order to test for equality or order
+**/
+List* initializeListFrom(void* (*allocate)(void* pool, size_t size), void* pool, char* (*printFunction)(void* toBePrinted),void (*deleteFunction)(void* toBeDeleted),int (*compareFunction)(const void* first,const void* second));
+
+
+/** Function to initialize a list that keeps its data in one contiguous array instead of in nodes.
+* Every other list function works on it exactly as on a linked list, but walking it is a linear scan
+* and adding to the back is amortized constant time, while adding or removing anywhere else moves
+* the elements after it. Meant for small lists that are mostly appended to. It has no nodes, head and
+* tail are always NULL, so code that follows head and next sees an empty list: use the iterator instead
+*@pre function pointer arguments must not be NULL
+*@post List structure has been allocated and initialized, the array is allocated by the first insert
+*@return On success returns newly allocated List struct. Returns NULL if malloc fails
+*@param printFunction - function pointer to print a single node of the list
+*@param deleteFunction - function pointer to delete a single piece of data from the list
+*@param compareFunction - function pointer to compare two nodes of the list in order to test for equality or order
+**/
+List* initializeArrayList(char* (*printFunction)(void* toBePrinted),void (*deleteFunction)(void* toBeDeleted),int (*compareFunction)(const void* first,const void* second));
+
+
+/** Function to initialize an array list whose head and array are allocated from a pool, see
+* initializeListFrom. An array that is outgrown is left in the pool
+*@pre allocate and the function pointer arguments must not be NULL
+*@post List structure has been allocated from pool and initialized
+*@return On success returns the new List struct. Returns NULL if allocate fails
+*@param allocate - returns size bytes from pool, or NULL
+*@param pool - passed to allocate unchanged
+*@param printFunction - function pointer to print a single node of the list
+*@param deleteFunction - function pointer to delete a single piece of data from the list
+*@param compareFunction - function pointer to compare two nodes of the list in order to test for equality or order
+**/
+List* initializeArrayListFrom(void* (*allocate)(void* pool, size_t size), void* pool, char* (*printFunction)(void* toBePrinted),void (*deleteFunction)(void* toBeDeleted),int (*compareFunction)(const void* first,const void* second));
+
+
 
 /**Function for creating a node for the linked list. 
 * This node contains abstracted (void *) data as well as previous and next
@@ -125,6 +192,30 @@ void insertSorted(List* list, void* toBeAdded);
 
 
 
+/** Sorts the list in place using the compare function pointer, in O(n log n) comparisons.
+* The sort is stable, so elements that compare equal keep the order they were in.
+*@pre List exists and has memory allocated to it.
+*@post The list is in order. No nodes or data are allocated or freed
+*@param list - a pointer to the List struct
+**/
+void sortList(List* list);
+
+
+
+/** Adds many elements to a sorted list at once. The new elements are sorted among themselves and then
+* merged in to the list in a single pass, so adding m elements to a list of n costs O(m log m + n)
+* comparisons instead of the O(m * n) of calling insertSorted m times. As with insertSorted, a new
+* element goes in front of any equal ones already in the list; equal new elements keep their order
+*@pre List exists, has memory allocated to it and is sorted.
+*@post The list is sorted and contains every non NULL element of toBeAdded
+*@param list - a pointer to the List struct
+*@param toBeAdded - an array of count pointers to data to add to the list, NULL entries are skipped
+*@param count - the number of entries in toBeAdded
+**/
+void insertSortedBatch(List* list, void** toBeAdded, int count);
+
+
+
 /** Removes data from from the list, deletes the node and frees the memory,
  * changes pointer values of surrounding nodes to maintain list structure.
  * returns the data 
@@ -139,6 +230,57 @@ void* deleteDataFromList(List* list, void* toBeDeleted);
 
 
 
+/** Removes the element that nextElement last returned through iter, in constant time for a linked list
+* and without calling the compare function. The iterator stays valid and carries on with the element
+* that came after the removed one. The data is returned, not freed
+ *@pre List exists. iter was created on it and the list has only been changed through iter since
+ *@post The element is no longer in the list
+ *@param list - a pointer to the List struct
+ *@param iter - the iterator that returned the element
+ *@return on success: void * pointer to the removed data. NULL if iter has not returned an element since
+ *        it was created, or since its last removeAt, insertAfter or spliceList
+ **/
+void* removeAt(List* list, ListIterator* iter);
+
+
+
+/** Adds data right after the element that nextElement last returned through iter, in constant time for a
+* linked list, or at the front of the list if iter has not returned anything yet. The iterator steps over the
+* new element, so it carries on with the element it would have returned anyway
+ *@pre List exists. iter was created on it and the list has only been changed through iter since
+ *@post The data is in the list right after the iterator's last element
+ *@param list - a pointer to the List struct
+ *@param iter - the iterator marking where to insert
+ *@param toBeAdded - a pointer to data that is to be added to the list
+ **/
+void insertAfter(List* list, ListIterator* iter, void* toBeAdded);
+
+
+
+/** Moves every element of source into dest at the iterator at, see insertAfter, or to the back of dest if at
+* is NULL. When both are linked lists whose nodes come from the same place (both malloc, or the same pool)
+* the nodes are relinked and not copied, which takes constant time apart from a walk over source's few node
+* slabs. Any other pair of lists is moved element by element. The data is never copied or freed
+ *@pre Both lists exist. at, if not NULL, was created on dest
+ *@post source is empty. Its data is in dest in the same order
+ *@param dest - a pointer to the List struct to move the elements to
+ *@param at - where in dest to put them, NULL for the back
+ *@param source - a pointer to the List struct to move the elements from
+ **/
+void spliceList(List* dest, ListIterator* at, List* source);
+
+
+
+/** Moves every element of source to the back of dest. Same as spliceList with no iterator
+ *@pre Both lists exist
+ *@post source is empty. Its data is at the back of dest in the same order
+ *@param dest - a pointer to the List struct to move the elements to
+ *@param source - a pointer to the List struct to move the elements from
+ **/
+void concatList(List* dest, List* source);
+
+
+
 /**Returns a pointer to the data at the front of the list. Does not alter list structure.
  *@pre The list exists and has memory allocated to it
  *@param list - a pointer to the List struct
@@ -167,6 +309,39 @@ returned string must be freed by the calling function.
 char* toString(List* list);
 
 
+/** Passes the string representation of every element, each followed by separator, to a write callback
+* in order from head to tail. Each element's text is freed once it is written, so the text of the whole list
+* is never held in memory at once.
+ *@pre List must exist, but does not have to have elements.
+ *@param list - a pointer to the List struct
+ *@param separator - text written after each element
+ *@param write - called with each piece of text and its length, returns false to stop
+ *@param context - passed to write unchanged
+ *@return true if every element was written, false if printData returned NULL or write failed
+ **/
+bool streamList(List* list, const char* separator, bool (*write)(void* context, const char* text, size_t length), void* context);
+
+
+/** Writes the string representation of every element, each followed by separator, to a file. See streamList
+ *@pre List must exist, but does not have to have elements. fp is open for writing
+ *@param list - a pointer to the List struct
+ *@param separator - text written after each element
+ *@param fp - the file to write to
+ *@return true on success, false if an element could not be printed or written
+ **/
+bool writeList(List* list, const char* separator, FILE* fp);
+
+
+/** Returns the string representation of every element, each followed by separator, as one string.
+* toString is joinList with a newline. The string is built in one growable buffer, so this takes time linear in its length.
+ *@pre List must exist, but does not have to have elements.
+ *@param list - a pointer to the List struct
+ *@param separator - text put after each element
+ *@return on success: char * to string representation of list (must be freed after use).  on failure: NULL
+ **/
+char* joinList(List* list, const char* separator);
+
+
 /** Function for creating an iterator for the linked list. 
  * This node contains abstracted (void *) data as well as previous and next
  * pointers to connect to other nodes in the list
@@ -0,0 +1,36 @@
+/**
+ * @file ParallelHelper.h
+ * @author Kevin ioi
+ * @date Oct 2018
+ * @brief File containing the functions needed to parse the cards of a vcf file on several threads
+ */
+
+#ifndef _PARALLELHELPER_H
+#define  _PARALLELHELPER_H
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "VCardParser.h"
+
+/*
+  A run of whole cards handed to one worker, and the cards it produced
+*/
+typedef struct cardChunk {
+  //byte range of the chunk, start is always the start of a line
+  size_t          start;
+  size_t          end;
+
+  //one entry per card in the chunk, NULL where the card was invalid
+  Card            **cards;
+  size_t          count;
+  size_t          capacity;
+
+  //error of the first invalid card in the chunk, OK if there wasn't one
+  VCardErrorCode  firstError;
+} CardChunk;
+
+VCardErrorCode parseCardsParallel(const char *source, size_t length, int threadCount, Card ***cards, size_t *cardCount);
+
+#endif
@@ -6,7 +6,7 @@
  */
 
 #ifndef _PARSEHELPER_H_
-#define  _PARSEHELPER_H
+#define  _PARSEHELPER_H_
 
 #include <string.h>
 #include <stdio.h>
@@ -14,6 +14,59 @@
 #include <ctype.h>
 
 #include "LinkedListAPI.h"
+#include "ArenaHelper.h"
+
+/*
+  Where one content line sits in the source, nothing is copied.
+  offset and length cover the raw bytes, including any folds, but not the closing CRLF.
+*/
+typedef struct lineSlice {
+  size_t  offset;
+  size_t  length;
+
+  //the line continues over one or more CRLF + whitespace folds
+  bool    hasFolds;
+
+  //the line ended with CRLF (only the last line of a file may not)
+  bool    terminated;
+
+  //false once there are no lines left, the other fields are then meaningless
+  bool    found;
+} LineSlice;
+
+/*
+  An unfolded content line being parsed. The extract and parse functions
+  read from text starting at index and move index past what they consume.
+*/
+typedef struct contentLine {
+  //unfolded line, not null terminated. Points in to the source unless the line had folds
+  const char  *text;
+
+  //number of chars in text, not counting the closing CRLF
+  size_t      length;
+
+  //current parse position in text
+  size_t      index;
+
+  //copied from the slice
+  bool        terminated;
+
+  //heap copy backing text for folded lines, NULL otherwise
+  char        *unfolded;
+} ContentLine;
+
+/*
+  Where one ;NAME=VALUE parameter sits in a content line, nothing is copied
+*/
+typedef struct parameterSlice {
+  size_t  nameStart;
+  size_t  nameLength;
+  size_t  valueStart;
+  size_t  valueLength;
+
+  //false once there are no parameters left, the other fields are then meaningless
+  bool    found;
+} ParameterSlice;
 
 char *printString(void *string);
 
@@ -23,21 +76,37 @@ int compareString(const void *string1, const void *string2);
 
 int strcmpIC(const char *string1,const char *string2);
 
-void parseContentLine(Property *newProp, char *contentLine);
+int strncmpIC(const char *string1, const char *string2, size_t n);
 
-VCardErrorCode extractGroup(char **contentLine, char **group);
+bool sliceEqualIC(const char *slice, size_t length, const char *string);
 
-VCardErrorCode extractProp(char **contentLine, char **prop);
+char *copySlice(const char *slice, size_t length);
+
+bool findGroup(const ContentLine *line, size_t *groupLength);
+
+VCardErrorCode extractGroup(ContentLine *line, char **group, CardArena *arena);
+
+VCardErrorCode extractProp(ContentLine *line, const char **prop, size_t *propLength);
 
 VCardErrorCode openFileRead(FILE **fp, char *fileName);
 
 VCardErrorCode readVCard(FILE *fp, char **fileContents);
 
-VCardErrorCode nextContentLine(char *source, char **nextLine, int *fileIndex);
+VCardErrorCode nextContentLine(const char *source, size_t sourceMax, size_t *fileIndex, LineSlice *slice);
+
+VCardErrorCode openContentLine(const char *source, const LineSlice *slice, ContentLine *line);
+
+VCardErrorCode openContentLineWith(const char *source, const LineSlice *slice, ContentLine *line, char **buffer, size_t *bufferSize);
+
+void closeContentLine(ContentLine *line);
+
+VCardErrorCode nextParameter(ContentLine *line, ParameterSlice *param);
+
+VCardErrorCode parseParameters(ContentLine *line, List *paramList, CardArena *arena);
 
-VCardErrorCode parseParameters(char ***contentLine, List *paramList);
+VCardErrorCode parsePropertyValues(ContentLine *line, List *propertyList, CardArena *arena);
 
-VCardErrorCode parsePropertyValues(char ***contentLine, List *propertyList);
+int countPropertyValues(ContentLine *line);
 
 char* toStringNoBreak(List * list);
 
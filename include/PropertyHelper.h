@@ -14,9 +14,10 @@
 
 #include "LinkedListAPI.h"
 #include "VCardParser.h"
+#include "ParseHelper.h"
 
 
-VCardErrorCode newProperty(char *name, char *group, Property **newProp, char **contentLine);
+VCardErrorCode newProperty(const char *name, size_t nameLength, char *group, Property **newProp, ContentLine *contentLine, CardArena *arena);
 
 Property *createProperty();
 
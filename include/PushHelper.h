@@ -0,0 +1,39 @@
+/**
+ * @file PushHelper.h
+ * @author Kevin ioi
+ * @date Oct 2018
+ * @brief File containing the state kept by a push parser between fragments
+ */
+
+#ifndef _PUSHHELPER_H
+#define  _PUSHHELPER_H
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "VCardParser.h"
+#include "CardHelper.h"
+
+/*
+  Parser fed a vcf stream in arbitrary fragments, see vcardParserOpen()
+*/
+struct vcardPushParser {
+  //the card put together from the lines seen so far
+  CardBuilder builder;
+
+  //raw bytes (folds and CRLF included) of the one content line that was cut off at the
+  //end of a fragment. Never holds more than a single content line
+  char        *pending;
+  size_t      pendingLength;
+  size_t      pendingSize;
+
+  //a card was invalid, lines are dropped until the next BEGIN:VCARD
+  bool        skipping;
+
+  //receives every finished card
+  void        (*onCard)(Card *card, void *context);
+  void        *context;
+};
+
+#endif
@@ -0,0 +1,29 @@
+/**
+ * @file ScanHelper.h
+ * @author Kevin ioi
+ * @date Sept 2018
+ * @brief File containing the functions needed to find structural chars in a content line
+ *        or a JSON string
+ */
+
+#ifndef _SCANHELPER_H
+#define  _SCANHELPER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+//classes of structural chars, or them together to look for more than one at once
+#define SCAN_CR         0x01  //'\r'
+#define SCAN_LF         0x02  //'\n'
+#define SCAN_DOT        0x04  //'.' ends a group name
+#define SCAN_SEMICOLON  0x08  //';' starts a parameter, separates values
+#define SCAN_COLON      0x10  //':' starts the values
+#define SCAN_EQUALS     0x20  //'=' ends a parameter name
+#define SCAN_QUOTE      0x40  //'"' ends a JSON string
+#define SCAN_BACKSLASH  0x80  //'\\' starts a JSON escape
+
+uint32_t classifyBlock(const char *block, unsigned classes);
+
+size_t scanFor(const char *data, size_t length, unsigned classes);
+
+#endif
@@ -40,7 +40,9 @@ typedef struct dt {
 //Represents a generic vCard parameter
 typedef struct param {
 	//Parameter name.  We will assume that the parameter name, even if malformed, does not exceed 200 bytes
-	char 	name[200]; 
+	//Parsed parameters share one interned copy of each name (see internName), so the name
+	//must not be written to. It must be malloc'd or come from internName
+	char* 	name; 
 
 	//Property description.  
 	char	value[]; 
@@ -58,6 +60,8 @@ typedef struct prop {
 
 	/* 	List of property parameters.  All objects in the list will be of type Parameter.
 		List may be empty if property parameters are absent.  List must never be NULL.  
+		Parsed properties keep parameters and values in array lists (initializeArrayList),
+		whose head is always NULL, so walk both with createIterator, not head and next
     */
     List*		parameters;
 
@@ -97,7 +101,6 @@ typedef struct vCard {
 	*/
 	DateTime* 	anniversary;
 
-
 } Card;
 
 // ************* Card parser functions - MUST be implemented ***************
@@ -139,17 +142,55 @@ char* printDate(void* toBePrinted);
  **/
 VCardErrorCode writeCard(const char* fileName, const Card* obj);
 
+/** Function to write a Card object in to memory, in the same vCard format as writeCard.
+ *@pre Card object exists, and is not NULL.
+ *@post Card has not been modified in any way. *out holds the card's vCard text, which
+        the caller must free
+ *@return the error code indicating success or the error encountered when traversing the Card
+ *@param obj - a pointer to a Card struct
+		 out - set to the malloc'd text, null terminated. NULL on error
+		 length - set to the number of bytes in *out, not counting the null
+ **/
+VCardErrorCode serializeCard(const Card* obj, char** out, size_t* length);
+
+/** Function to write many Card objects, one after another, as one multi-card vCard document.
+ *@pre fd is open for writing (a file, pipe or socket), cards holds cardCount Cards that are not NULL
+ *@post Cards have not been modified in any way, and the whole document has been written to fd
+        at its current position. Cards are formatted a batch at a time and each batch is
+        written with one writev. fd is not closed
+ *@return the error code indicating success or the error encountered. On error part of the
+          document may already have been written
+ *@param fd - the file descriptor to write to
+		 cards - the cards to write
+		 cardCount - the number of cards
+ **/
+VCardErrorCode writeCards(int fd, Card** cards, size_t cardCount);
+
 
 
 /** Function to writing a Card object into a file in iCard format.
  *@pre Card object exists, and is not NULL.
- *@post Card has not been modified in any way, and a file representing the
-        Card contents in vCard format has been created
+ *@post Card contents have not been modified in any way, and nothing is written to obj. Cards
+        from the create functions keep optionalProperties checked as addProperty adds to them,
+        so validating does not walk the list. After any other edit to optionalProperties (a
+        list function such as deleteDataFromList, removeAt or spliceList) the answer is still
+        right, but every call walks the whole list until addProperty or resetCardValidation
+        brings the card up to date. birthday and anniversary are checked on every call
  *@return the error code indicating success or the error encountered when validating the Card
  *@param obj - a pointer to a Card struct
  **/
 VCardErrorCode validateCard(const Card* obj);
 
+/** Function to check every property of optionalProperties again and remember the result.
+ *  Call it after editing optionalProperties other than through addProperty, whether with
+ *  the list functions or by changing a property's name or values in place
+ *@pre Card object exists
+ *@post all of optionalProperties has been checked again, for the next validateCard to use
+ *@return void
+ *@param obj - a pointer to a Card struct
+ **/
+void resetCardValidation(Card* obj);
+
 
 /** Function for converting a list of strings into a JSON string
  *@pre List exists, is not null, and is valid
@@ -205,6 +246,33 @@ char* dtToJSON(const DateTime* prop);
 DateTime* JSONtoDT(const char* str);
 
 
+/** Function for converting a whole Card into a JSON string
+ *@pre Card exists, is not null, and is valid
+ *@post Card has not been modified in any way, and a JSON string has been created holding
+        {"fn":,"optionalProperties":[],"birthday":,"anniversary":}. Properties are in the
+        propToJSON format plus a "parameters" array of {"name":,"value":} objects, dates are
+        in the dtToJSON format, a missing date is null
+ *@return newly allocated JSON string.  May be NULL.
+ *@param obj - a pointer to a Card struct
+ **/
+char* cardToJSON(const Card* obj);
+
+
+/** Function for exporting every vCard of a (large) vcf file as NDJSON, one cardToJSON object
+ *  per line
+ *@pre fileName is not NULL and has the correct extension, fd is open for writing
+ *@post the JSON of every valid card has been written to fd in file order. Cards are parsed
+        and written one at a time, so memory use does not grow with the size of the file.
+        Blank lines between and after cards are skipped, as with nextCard. fd is not closed
+ *@return OK if every card was valid, otherwise the error of the first invalid card (which
+          is left out of the output). INV_FILE if the file can't be opened, WRITE_ERROR if
+          writing fails, in which case part of the output may already have been written
+ *@param fileName - the name of the vcf file
+		 fd - the file descriptor to write to
+ **/
+VCardErrorCode exportNDJSON(const char* fileName, int fd);
+
+
 /** Function for creating a Card struct from an JSON string
  *@pre String is not null, and is valid
  *@post String has not been modified in any way, and a Card struct has been created
@@ -214,6 +282,17 @@ DateTime* JSONtoDT(const char* str);
 Card* JSONtoCard(const char* str);
 
 
+/** Function for creating a whole Card struct from a JSON string written by cardToJSON
+ *@pre String is not null, and is valid
+ *@post String has not been modified in any way, and a Card has been created with its fn,
+        optionalProperties (with their parameters), birthday and anniversary. Keys may be in
+        any order and unknown keys are ignored, only fn is required
+ *@return a newly allocated Card, to be freed with deleteCard.  May be NULL.
+ *@param str - a pointer to a JSON string
+ **/
+Card* JSONtoFullCard(const char* str);
+
+
 /** Function for adding an optional Property to a Card object
  *@pre both arguments are not NULL and valid
  *@post Property has not been modified in any way, and its address had been added to 
@@ -227,4 +306,193 @@ void addProperty(Card* card, const Property* toBeAdded);
 // *************************************************************************
 
 
+// ************* Bulk parsing functions ***************************************
+
+/** Function to create a Card object from a vCard held in memory, without any file I/O.
+ *@pre data is not NULL
+ *@post data has not been modified in any way. It does not need to be null terminated
+ *@return the error code indicating success or the error encountered when parsing the data
+ *@param data - the vcf contents
+		 length - the number of bytes in data
+		 newCardObject - set to the newly created Card, NULL on error
+ **/
+VCardErrorCode createCardFromBuffer(const char* data, size_t length, Card** newCardObject);
+
+
+/** Function to create a Card object from a vcf file, allocating the whole card from one arena.
+ *@pre fileName is not NULL and has the correct extension
+ *@post the card is exactly what createCard would build, but every Property, Parameter, string,
+        list and node in it comes from a few large blocks, which deleteCard releases in one go.
+        Properties added later with addProperty are freed along with the card. Parts of the
+        card must not be freed or removed on their own
+ *@return the error code indicating success or the error encountered when parsing the card
+ *@param fileName - the name of the vcf file
+		 newCardObject - set to the newly created Card, NULL on error
+ **/
+VCardErrorCode createCardInArena(char* fileName, Card** newCardObject);
+
+
+/** Function to check a vcf file without building a Card from it.
+ *@pre fileName is not NULL and has the correct extension
+ *@post the first vCard in the file has been parsed and validated, but nothing is kept. No
+        Property, Parameter, value or list is allocated, only counters
+ *@return the same error code as createCard, followed by validateCard on the card when
+          createCard succeeds, would give
+ *@param fileName - the name of the vcf file
+ **/
+VCardErrorCode validateVCardFile(const char* fileName);
+
+
+/** Function to check a vcf file already in memory without building a Card from it.
+ *@pre data holds length bytes, it does not need to be null terminated
+ *@post data has not been modified, nothing is kept
+ *@return the same error code as createCardFromBuffer, followed by validateCard on the card
+          when it succeeds, would give
+ *@param data - the vcf file contents
+		 length - the number of bytes in data
+ **/
+VCardErrorCode validateVCardBuffer(const char* data, size_t length);
+
+
+/** Function to get the shared copy of a property, group or parameter name.
+ *@pre name is not NULL
+ *@post name is in the process wide table of names that parsed cards point in to. The
+        returned string lives until the process exits and must not be freed or changed.
+        Safe to call from several threads at once
+ *@return the shared copy, or NULL if name is 200 chars or longer, the table is full, or
+          memory ran out
+ *@param name - the name to look up
+ **/
+const char* internName(const char* name);
+
+
+//Cursor over a vcf file holding any number of vCards, one after another
+typedef struct cardStream CardStream;
+
+/** Function to open a vcf file holding any number of vCards for card by card parsing.
+ *@pre fileName is not NULL and has the correct extension
+ *@post stream points to a new stream positioned at the first card. The file is mapped,
+        not read in, so memory use does not grow with the number of cards
+ *@return the error code indicating success or the error encountered opening the file
+ *@param fileName - the name of the vcf file
+		 stream - set to the newly allocated stream, NULL on error
+ **/
+VCardErrorCode openCardStream(const char* fileName, CardStream** stream);
+
+
+/** Function to open a caller's buffer holding any number of vCards for card by card parsing.
+ *@pre data is not NULL and stays valid until closeCardStream is called
+ *@post stream points to a new stream positioned at the first card. data is neither
+        copied nor modified, and does not need to be null terminated
+ *@return the error code indicating success or the error encountered
+ *@param data - the vcf contents
+		 length - the number of bytes in data
+		 stream - set to the newly allocated stream, NULL on error
+ **/
+VCardErrorCode openCardStreamFromBuffer(const char* data, size_t length, CardStream** stream);
+
+
+/** Function to parse the next vCard of a stream.
+ *@pre stream was returned by openCardStream
+ *@post newCardObject is a new Card that must be freed with deleteCard, or NULL once the
+        end of the stream is reached (the return value is OK in that case). Blank lines
+        between and after cards are skipped. If a card is
+        invalid the stream skips ahead to the next BEGIN:VCARD, so the following call
+        continues with the next card
+ *@return the error code indicating success or the error encountered parsing the card
+ *@param stream - a pointer to a CardStream
+		 newCardObject - set to the parsed Card
+ **/
+VCardErrorCode nextCard(CardStream* stream, Card** newCardObject);
+
+
+/** Function to choose how the cards of a stream are allocated.
+ *@pre stream was returned by openCardStream or openCardStreamFromBuffer
+ *@post cards returned by later calls to nextCard are allocated from an arena each, as with
+        createCardInArena, if useArena is true. Streams start out with it off
+ *@param stream - a pointer to a CardStream
+		 useArena - true for arena cards, false for malloc'd cards
+ **/
+void setCardStreamArena(CardStream* stream, bool useArena);
+
+
+/** Function to parse every vCard of a (large) vcf file on several threads.
+ *@pre fileName is not NULL and has the correct extension
+ *@post cards is a new array with one entry per card, in the same order as the file. Entries
+        for invalid cards are NULL, all other entries must be freed with deleteCards
+ *@return OK if every card was valid, otherwise the error of the first invalid card in the file.
+          On INV_FILE or OTHER_ERROR no cards are returned
+ *@param fileName - the name of the vcf file
+		 threadCount - number of threads to use, 0 for one per cpu
+		 cards - set to the new array of cards
+		 cardCount - set to the number of entries in cards
+ **/
+VCardErrorCode createCardsParallel(const char* fileName, int threadCount, Card*** cards, size_t* cardCount);
+
+
+/** Function to free an array of cards returned by createCardsParallel.
+ *@post every Card in the array and the array itself have been freed
+ *@param cards - the array of cards, may contain NULL entries
+		 cardCount - the number of entries in cards
+ **/
+void deleteCards(Card** cards, size_t cardCount);
+
+
+/** Function to close a stream and release the file.
+ *@post stream has been freed. Cards already returned by nextCard are not affected
+ *@param stream - a pointer to a CardStream, may be NULL
+ **/
+void closeCardStream(CardStream* stream);
+
+
+//Parser that is handed a vcf stream a piece at a time, as it arrives on a socket or pipe
+typedef struct vcardPushParser VCardPushParser;
+
+/** Function to create a push parser.
+ *@pre onCard is not NULL
+ *@post parser points to a new parser waiting for the first BEGIN:VCARD line
+ *@return the error code indicating success or the error encountered
+ *@param onCard - called with each card as soon as its END:VCARD line has been fed. The card
+                  belongs to the callback and must be freed with deleteCard
+		 context - passed through to onCard unchanged
+		 parser - set to the newly allocated parser, NULL on error
+ **/
+VCardErrorCode vcardParserOpen(void (*onCard)(Card* card, void* context), void* context, VCardPushParser** parser);
+
+
+/** Function to feed the next piece of a vcf stream to a push parser.
+ *@pre parser was returned by vcardParserOpen
+ *@post every card completed by bytes has been handed to onCard. Pieces may be split anywhere,
+        including inside a CRLF or a fold. bytes is not kept, only a content line left
+        unfinished at the end of bytes is copied. Blank lines between and after cards are
+        ignored. If a card is invalid it is dropped and parsing picks up again at the next
+        BEGIN:VCARD
+ *@return OK, or the error of the first invalid card finished by this piece. OTHER_ERROR
+          if memory ran out, the parser should then be closed
+ *@param parser - a pointer to a VCardPushParser
+		 bytes - the next bytes of the stream, not null terminated
+		 length - the number of bytes
+ **/
+VCardErrorCode vcardParserFeed(VCardPushParser* parser, const char* bytes, size_t length);
+
+
+/** Function to tell a push parser the stream has ended.
+ *@pre parser was returned by vcardParserOpen
+ *@post the last line, which does not need a CRLF, has been parsed. The parser is ready
+        for a new stream
+ *@return OK, or the error of the last card, INV_CARD if the stream ended inside a card
+ *@param parser - a pointer to a VCardPushParser
+ **/
+VCardErrorCode vcardParserFinish(VCardPushParser* parser);
+
+
+/** Function to free a push parser.
+ *@post parser and any card it was part way through have been freed
+ *@param parser - a pointer to a VCardPushParser, may be NULL
+ **/
+void vcardParserClose(VCardPushParser* parser);
+
+// *************************************************************************
+
+
 #endif	
@@ -5,13 +5,14 @@
  * @brief File containing the functions needed to
  */
 
-#ifndef _VALIDATIONHELPER_H_
+#ifndef _VALIDATIONHELPER_H
 #define  _VALIDATIONHELPER_H
 
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <stdint.h>
 
 #include "LinkedListAPI.h"
 
@@ -19,33 +20,41 @@
 typedef enum properties {SOURCE, KIND, XML, FN, N, NICKNAME, PHOTO, BDAY,
 						ANNIVERSARY, GENDER, ADR, TEL, EMAIL, IMPP, LANG, TZ, GEO, TITLE,
 						ROLE, LOGO, ORG, MEMBER, RELATED, CATEGORIES, NOTE, PRODID, REV,
-						SOUND, UID, CLIENTPIDMAP, URL, VERSION, KEY, FBURL, CALADRURI, CALURI} pValue;
+						SOUND, UID, CLIENTPIDMAP, URL, VERSION, KEY, FBURL, CALADRURI, CALURI,
+						UNKNOWN_PROPERTY} pValue;//UNKNOWN_PROPERTY is also the number of known properties
 
-typedef struct propertyNode{
-	int count;
-	char *name;
-	}pNode;
+/*
+  What validating a card's optionalProperties found, kept in the card's CardRecord. Dates
+  aren't part of it: checking one only looks at a few bytes, and a date freed and replaced
+  by one at the same address couldn't be told apart from the date that was checked
+*/
+typedef struct cardValidation {
+	unsigned long changes;//optionalProperties->changes when the rest was last brought up to date
+	VCardErrorCode status;//first error among the properties, OK if none
+	bool kindIsGroup;//a KIND:group property was seen, MEMBER needs one
+	int propertyCounts[UNKNOWN_PROPERTY];
+} CardValidation;
 
 
-VCardErrorCode validateProp(const Property *prop, List *pList);
+pValue propertyID(const char *name, size_t length);
 
-VCardErrorCode validateParam(const Parameter *param);
+VCardErrorCode validateProperties(const Card *card);
 
-VCardErrorCode validateDT(const DateTime *date);
+void countProperties(CardValidation *validation, const List *properties);
 
-pNode *createPNode(char *name);
+void appendProperty(Card *card, Property *prop);
 
-void loadPropertyCounter(List *pList);
+VCardErrorCode validateProp(const Property *prop, int *propertyCounts);
 
-void deletePropNode(void *toDelete);
+VCardErrorCode checkPropertyRules(pValue id, int valueCount, int *propertyCounts);
 
-char *printPropNode(void *toPrint);
+VCardErrorCode validateParam(const Parameter *param);
 
-int countProperty(char *name, List *pList);
+VCardErrorCode validateDT(const DateTime *date);
 
-int cmpPropNode(const void *one, const void *two);
+VCardErrorCode validateDTFields(const DateTime *date, size_t textLength);
 
-bool nodeNameCmp(const void *node, const void *name);
+VCardErrorCode checkCard(const char *vCardString, size_t maxIndex, size_t *lineIndex);
 
 
 #endif
@@ -9,17 +9,50 @@
 #define  _PRINTCARDHELPER_H
 
 
+/*
+  Growable buffer a card is written in to before it goes to the file
+*/
+typedef struct outBuffer {
+  char    *data;
+
+  //bytes written so far
+  size_t  length;
+
+  //bytes allocated
+  size_t  size;
+
+  //octets on the current content line so far, what folding is worked out from
+  size_t  lineLength;
+
+  //fold content lines at 75 octets as they are appended
+  bool    fold;
+} OutBuffer;
+
 VCardErrorCode openFileWrite(FILE **fp, const char *fileName);
 
-VCardErrorCode writeProperty(FILE **fp, Property *writeProp);
+bool startOutBuffer(OutBuffer *out, size_t size);
+
+void freeOutBuffer(OutBuffer *out);
+
+bool reserveBytes(OutBuffer *out, size_t length);
+
+bool appendBytes(OutBuffer *out, const char *bytes, size_t length);
+
+bool appendString(OutBuffer *out, const char *string);
+
+bool endLine(OutBuffer *out);
+
+VCardErrorCode writeProperty(OutBuffer *out, const Property *writeProp);
+
+VCardErrorCode writeOptionalProps(OutBuffer *out, List *props);
 
-VCardErrorCode propListToString(char **contentLine, List *values);
+VCardErrorCode writeDateTime(OutBuffer *out, const char *name, const DateTime *writeDate);
 
-VCardErrorCode paramListToString(char **contentLine, List *parameters);
+VCardErrorCode writeCardTo(OutBuffer *out, const Card *obj);
 
-VCardErrorCode writeOptionalProps(FILE **fp, List *props);
+VCardErrorCode flushOutBuffer(int fd, OutBuffer *out);
 
-VCardErrorCode writeDateTime(char **contentLine, DateTime *writeDate);
+VCardErrorCode writeCardBatch(int fd, Card **cards, size_t cardCount);
 
 
 #endif
@@ -0,0 +1,214 @@
+/**
+ * @file ArenaHelper.c
+ * @author Kevin ioi
+ * @date Oct 2018
+ * @brief File containing the bump allocator an arena card is built from. Every Property,
+ *        Parameter, string, List head and Node of the card comes out of a few large blocks,
+ *        so parsing does a handful of mallocs instead of hundreds and deleting is one walk
+ *        over the blocks
+ */
+
+#include "ArenaHelper.h"
+
+//first block is sized for a typical card, later ones double up to the cap
+#define ARENA_FIRST_BLOCK 4096
+#define ARENA_MAX_BLOCK   (64 * 1024)
+
+#define ARENA_ALIGN sizeof(max_align_t)
+
+/**
+* newBlock()
+*
+**/
+static ArenaBlock *newBlock(size_t size)
+{
+  ArenaBlock *block;
+
+  if ((block = malloc(sizeof(ArenaBlock) + size)) == NULL)
+    return NULL;
+
+  block->next = NULL;
+  block->used = 0;
+  block->size = size;
+
+  return block;
+}
+
+/**
+* newArena()
+*
+* the arena struct itself is the first thing allocated from its first block
+**/
+CardArena *newArena(void)
+{
+  ArenaBlock *block;
+  CardArena *arena;
+
+  if ((block = newBlock(ARENA_FIRST_BLOCK)) == NULL)
+    return NULL;
+
+  arena = (CardArena*)block->data;
+  block->used = (sizeof(CardArena) + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+
+  arena->blocks = block;
+  arena->cleanups = NULL;
+
+  return arena;
+}
+
+/**
+* arenaAlloc()
+*
+* bump allocate size bytes, aligned for any type. Takes a void* so it can be
+* handed to initializeListFrom() as a list's allocator
+**/
+void *arenaAlloc(void *pool, size_t size)
+{
+  CardArena *arena = (CardArena*)pool;
+  ArenaBlock *block = arena->blocks;
+  size_t newSize;
+  void *memory;
+
+  size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+
+  if (block->size - block->used < size)//current block is full, start another
+  {
+    newSize = block->size * 2 > ARENA_MAX_BLOCK ? ARENA_MAX_BLOCK : block->size * 2;
+    if (newSize < size)//bigger than a whole block, give it one of its own
+      newSize = size;
+
+    if ((block = newBlock(newSize)) == NULL)
+      return NULL;
+
+    block->next = arena->blocks;
+    arena->blocks = block;
+  }
+
+  memory = (char*)block->data + block->used;
+  block->used += size;
+
+  return memory;
+}
+
+/**
+* arenaAdopt()
+*
+* make the arena responsible for a malloc'd object (a property added to an arena
+* card after parsing), it is deleted along with the arena
+**/
+bool arenaAdopt(CardArena *arena, void *data, void (*deleteData)(void *toBeDeleted))
+{
+  ArenaCleanup *cleanup;
+
+  if ((cleanup = arenaAlloc(arena, sizeof(ArenaCleanup))) == NULL)
+    return false;
+
+  cleanup->data = data;
+  cleanup->deleteData = deleteData;
+  cleanup->next = arena->cleanups;
+  arena->cleanups = cleanup;
+
+  return true;
+}
+
+/**
+* freeArena()
+*
+**/
+void freeArena(CardArena *arena)
+{
+  ArenaCleanup *cleanup;
+  ArenaBlock *block, *next;
+
+  if (arena == NULL)
+    return;
+
+  for (cleanup = arena->cleanups; cleanup != NULL; cleanup = cleanup->next)
+    cleanup->deleteData(cleanup->data);
+
+  //the arena struct lives in the oldest block, which is freed last
+  for (block = arena->blocks; block != NULL; block = next)
+  {
+    next = block->next;
+    free(block);
+  }
+}
+
+/**
+* allocFrom()
+*
+* arenaAlloc if there is an arena, plain malloc otherwise
+**/
+void *allocFrom(CardArena *arena, size_t size)
+{
+  if (arena == NULL)
+    return malloc(size);
+
+  return arenaAlloc(arena, size);
+}
+
+/**
+* copySliceFrom()
+*
+* copySlice, in to the arena if there is one
+**/
+char *copySliceFrom(CardArena *arena, const char *slice, size_t length)
+{
+  char *copy;
+
+  if ((copy = allocFrom(arena, length + 1)) == NULL)
+    return NULL;
+
+  memcpy(copy, slice, length);
+  copy[length] = '\0';
+
+  return copy;
+}
+
+/**
+* keepData()
+*
+* delete function of arena lists, the data goes when the arena does
+**/
+static void keepData(void *toBeDeleted)
+{
+  (void)toBeDeleted;
+}
+
+/**
+* listFrom()
+*
+* initializeList, with the head and every node in the arena if there is one
+**/
+List *listFrom(CardArena *arena, char* (*printFunction)(void* toBePrinted),void (*deleteFunction)(void* toBeDeleted),int (*compareFunction)(const void* first,const void* second))
+{
+  if (arena == NULL)
+    return initializeList(printFunction, deleteFunction, compareFunction);
+
+  return initializeListFrom(arenaAlloc, arena, printFunction, keepData, compareFunction);
+}
+
+/**
+* arrayListFrom()
+*
+* initializeArrayList, with the head and the array in the arena if there is one
+**/
+List *arrayListFrom(CardArena *arena, char* (*printFunction)(void* toBePrinted),void (*deleteFunction)(void* toBeDeleted),int (*compareFunction)(const void* first,const void* second))
+{
+  if (arena == NULL)
+    return initializeArrayList(printFunction, deleteFunction, compareFunction);
+
+  return initializeArrayListFrom(arenaAlloc, arena, printFunction, keepData, compareFunction);
+}
+
+/**
+* discardFrom()
+*
+* delete something that failed part way through being built. Arena memory is left
+* where it is, it goes when the arena does
+**/
+void discardFrom(CardArena *arena, void *data, void (*deleteData)(void *toBeDeleted))
+{
+  if (arena == NULL && data != NULL)
+    deleteData(data);
+}
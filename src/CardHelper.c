@@ -2,20 +2,29 @@
  * @file CardHelper.c
  * @author Kevin ioi
  * @date Sept 2018
- * @brief File containing the helper function used to initialize a vCard struct
+ * @brief File containing the helper functions used to initialize a vCard struct and
+ *        build one from the content lines of a vcf file
  */
 
 #include "VCardParser.h"
 #include "ParseHelper.h"
 #include "LinkedListAPI.h"
+#include "CardHelper.h"
+#include "PropertyHelper.h"
+#include "DateHelper.h"
+#include "ScanHelper.h"
+#include "InternHelper.h"
+#include "ValidationHelper.h"
 
 Card *initializeCard(char* (*printProp)(void* toBePrinted),void (*deleteProp)(void* toBeDeleted),int (*compareProp)(const void* first,const void* second))
 {
-  Card *newCard = malloc(sizeof(Card));
+  CardRecord *record = malloc(sizeof(CardRecord));
+  Card *newCard;
 
-  if (newCard == NULL)//malloc failed
+  if (record == NULL)//malloc failed
     return NULL;
 
+  newCard = &record->card;
   newCard->fn = NULL;
   newCard->birthday = NULL;
   newCard->anniversary = NULL;
@@ -23,9 +32,380 @@ Card *initializeCard(char* (*printProp)(void* toBePrinted),void (*deleteProp)(vo
 
   if(newCard->optionalProperties == NULL)
   {
-    free(newCard);
+    free(record);
     return NULL;
   }
 
+  record->arena = NULL;
+  countProperties(&record->validation, newCard->optionalProperties);
+  newCard->optionalProperties->owner = newCard;
+
+  return newCard;
+}
+
+/**
+* initializeArenaCard()
+*
+* same as initializeCard, but the card is the first thing in a new arena that the rest
+* of it will be allocated from
+**/
+Card *initializeArenaCard(void)
+{
+  CardArena *arena;
+  CardRecord *record;
+  Card *newCard;
+
+  if ((arena = newArena()) == NULL)
+    return NULL;
+
+  if ((record = arenaAlloc(arena, sizeof(CardRecord))) == NULL)
+  {
+    freeArena(arena);
+    return NULL;
+  }
+
+  newCard = &record->card;
+  newCard->fn = NULL;
+  newCard->birthday = NULL;
+  newCard->anniversary = NULL;
+
+  if ((newCard->optionalProperties = listFrom(arena, printProperty, deleteProperty, compareProperties)) == NULL)
+  {
+    freeArena(arena);
+    return NULL;
+  }
+
+  record->arena = arena;
+  countProperties(&record->validation, newCard->optionalProperties);
+  newCard->optionalProperties->owner = newCard;
+
   return newCard;
 }
+
+/**
+* cardRecord()
+*
+* the record card was allocated as, or NULL if card was put together by hand and has
+* no record around it
+**/
+CardRecord *cardRecord(const Card *card)
+{
+  if (card == NULL || card->optionalProperties == NULL || card->optionalProperties->owner != card)
+    return NULL;
+
+  return (CardRecord*)card;
+}
+
+/**
+* cardArena()
+*
+* the arena card lives in, NULL for a malloc card or one put together by hand
+**/
+CardArena *cardArena(const Card *card)
+{
+  CardRecord *record = cardRecord(card);
+
+  return record == NULL ? NULL : record->arena;
+}
+
+/**
+* findNextCard()
+*
+* index of the first line at or after from that starts with BEGIN:VCARD, or maxIndex
+* if there isn't one
+**/
+size_t findNextCard(const char *vCardString, size_t maxIndex, size_t from)
+{
+  size_t i = from;
+
+  while (i + 11 <= maxIndex)
+  {
+    if ((i == 0 || vCardString[i-1] == '\n') && strncmpIC(&vCardString[i], "BEGIN:VCARD", 11) == 0)
+      return i;
+
+    i += scanFor(&vCardString[i], maxIndex - i, SCAN_LF) + 1;//jump to the start of the next line
+  }
+
+  return maxIndex;
+}
+
+/**
+* skipBlankLines()
+*
+* index of the first line at or after from that has something other than whitespace on it,
+* or maxIndex if only whitespace is left
+**/
+size_t skipBlankLines(const char *vCardString, size_t maxIndex, size_t from)
+{
+  size_t i, lineStart = from;
+
+  for (i = from; i < maxIndex; i++)
+  {
+    if (vCardString[i] == '\n')
+      lineStart = i + 1;
+    else if (vCardString[i] != ' ' && vCardString[i] != '\t' && vCardString[i] != '\r')
+      return lineStart;
+  }
+
+  return maxIndex;
+}
+
+/**
+* skipBrokenCard()
+*
+* where to carry on after the card that started at cardStart failed with *lineIndex at
+* lineIndex: the next BEGIN:VCARD line, making sure to move past the broken card's own
+**/
+size_t skipBrokenCard(const char *vCardString, size_t maxIndex, size_t cardStart, size_t lineIndex)
+{
+  return findNextCard(vCardString, maxIndex, lineIndex > cardStart ? lineIndex : cardStart + 1);
+}
+
+/**
+* beginsCard()
+*
+* true for the BEGIN:VCARD line that every card starts with
+**/
+bool beginsCard(const ContentLine *contentLine)
+{
+  return contentLine->terminated && sliceEqualIC(contentLine->text, contentLine->length, "BEGIN:VCARD");
+}
+
+/**
+* resetCardBuilder()
+*
+**/
+static void resetCardBuilder(CardBuilder *builder)
+{
+  builder->card = NULL;
+  builder->stage = EXPECT_BEGIN;
+}
+
+/**
+* startCardBuilder()
+*
+* ready builder for the BEGIN:VCARD line of a new card. With useArena every card
+* it builds is allocated from an arena of its own
+**/
+void startCardBuilder(CardBuilder *builder, bool useArena)
+{
+  resetCardBuilder(builder);
+  builder->useArena = useArena;
+}
+
+/**
+* clearCardBuilder()
+*
+* throw away whatever card was half built and go back to waiting for BEGIN:VCARD
+**/
+void clearCardBuilder(CardBuilder *builder)
+{
+  deleteCard(builder->card);
+  resetCardBuilder(builder);
+}
+
+/**
+* addCardProperty()
+*
+* adds one regular content line (anything after VERSION) to card. Sets *endFound once
+* the END:VCARD line is reached
+**/
+static VCardErrorCode addCardProperty(Card *card, ContentLine *contentLine, bool *endFound)
+{
+  VCardErrorCode parseStatus;//the current status of the parsing
+  char *group = NULL;//string to hold a property's group strings, if found
+  const char *propName;//property name, points in to the content line
+  size_t nameLength;
+  pValue id;//which property the name is, UNKNOWN_PROPERTY for BEGIN, END and X- names
+  Property *prop;//property object handler
+  DateTime *newDT;//handler for new datetime objects
+  CardArena *arena = cardArena(card);//where the card's pieces come from, NULL for malloc
+
+  if ((parseStatus = extractGroup(contentLine, &group, arena)) != OK)
+    return parseStatus;
+
+  if ((parseStatus = extractProp(contentLine, &propName, &nameLength)) != OK)
+  {
+    discardFrom(arena, group, freeName);
+    return parseStatus;
+  }
+
+  id = propertyID(propName, nameLength);
+
+  if(id == BDAY)//found bday property
+  {
+    discardFrom(arena, group, freeName);
+
+    if (card->birthday != NULL)//found multiple birthday properties
+      parseStatus = INV_CARD;
+    else if ((parseStatus = newDate(&newDT, contentLine, arena)) == OK)
+      card->birthday = newDT;
+  }
+  else if(id == ANNIVERSARY)//found Anniversary property
+  {
+    discardFrom(arena, group, freeName);
+
+    if (card->anniversary != NULL)//found multiple anniversary properties
+      parseStatus = INV_CARD;
+    else if ((parseStatus = newDate(&newDT, contentLine, arena)) == OK)
+      card->anniversary = newDT;
+  }
+  else if (id == UNKNOWN_PROPERTY && sliceEqualIC(propName, nameLength, "END"))//found end flag
+  {
+    discardFrom(arena, group, freeName);
+
+    if (sliceEqualIC(&contentLine->text[contentLine->index], contentLine->length - contentLine->index, ":VCARD"))
+      *endFound = true;
+    else
+      parseStatus = INV_CARD;
+  }
+  else if (id == UNKNOWN_PROPERTY && sliceEqualIC(propName, nameLength, "BEGIN"))//found another begin flag
+  {
+    discardFrom(arena, group, freeName);
+    parseStatus = INV_CARD;
+  }
+  else if (nameLength < 1)//have standard property type, but no name
+  {
+    discardFrom(arena, group, freeName);
+    parseStatus = INV_PROP;
+  }
+  else if((parseStatus = newProperty(propName, nameLength, group, &prop, contentLine, arena))==OK)//build property
+  {
+    if(getLength(prop->values)==0)//make sure the property had a value
+    {
+      discardFrom(arena, prop, deleteProperty);
+      parseStatus = INV_PROP;
+    }
+    else if (id == N && getLength(prop->values) != 5) {//check if name property had enough values
+      discardFrom(arena, prop, deleteProperty);
+      parseStatus = INV_PROP;
+    }
+    else if (id == ADR && getLength(prop->values) != 7) {//check if address property had enough values
+      discardFrom(arena, prop, deleteProperty);
+      parseStatus = INV_PROP;
+    }
+    else if (id == FN && card->fn ==NULL)//new FN property
+    {
+      card->fn = prop;
+    }
+    else//optional property
+    {
+      appendProperty(card, prop);
+    }
+  }
+
+  return parseStatus;
+}
+
+/**
+* addCardLine()
+*
+* feed the next content line of a card to builder. When the line is END:VCARD the finished
+* card is handed over through *finishedCard and builder is ready for the next card.
+* On error the half built card is deleted and builder starts over
+**/
+VCardErrorCode addCardLine(CardBuilder *builder, ContentLine *contentLine, Card **finishedCard)
+{
+  VCardErrorCode parseStatus = OK;
+  bool endFound = false;
+
+  *finishedCard = NULL;
+
+  switch (builder->stage)
+  {
+    case EXPECT_BEGIN://make sure the begin tag starts the card
+      if (!beginsCard(contentLine))
+        parseStatus = INV_CARD;
+      else if((builder->card = builder->useArena ? initializeArenaCard() :
+                               initializeCard(printProperty, deleteProperty, compareProperties)) == NULL)
+        parseStatus = OTHER_ERROR;
+      else
+        builder->stage = EXPECT_VERSION;
+      break;
+
+    case EXPECT_VERSION://make sure the vcard is version 4.0
+      if (!contentLine->terminated || !sliceEqualIC(contentLine->text, contentLine->length, "VERSION:4.0"))
+        parseStatus = INV_CARD;
+      else
+        builder->stage = EXPECT_PROPERTY;
+      break;
+
+    case EXPECT_PROPERTY:
+      if ((parseStatus = addCardProperty(builder->card, contentLine, &endFound)) == OK && endFound)
+      {
+        if(builder->card->fn == NULL)
+        {
+          parseStatus = INV_CARD;
+        }
+        else
+        {
+          *finishedCard = builder->card;
+          resetCardBuilder(builder);
+        }
+      }
+      break;
+  }
+
+  if (parseStatus != OK)
+    clearCardBuilder(builder);
+
+  return parseStatus;
+}
+
+/**
+* parseCard()
+*
+* parses the single vCard that starts at *lineIndex in vCardString, in one pass over
+* the lines. On return *lineIndex is just past the END:VCARD line, ready for the next card.
+* If the card is cut short by the BEGIN:VCARD of another, *lineIndex is left on that line
+* so the next card isn't lost with this one. With useArena the card is allocated from an
+* arena of its own
+**/
+VCardErrorCode parseCard(const char *vCardString, size_t maxIndex, size_t *lineIndex, bool useArena, Card **newCardObject)
+{
+  VCardErrorCode parseStatus = OK;//the current status of the parsing
+  CardBuilder builder;//the card put together so far
+  LineSlice slice;//where the current content line is in vCardString
+  ContentLine contentLine;//the current content line being parsed
+  size_t lineStart;//where the current content line begins
+  BuildStage stage;//what the builder was waiting for before the current line
+
+  *newCardObject = NULL;
+
+  if (maxIndex < 20)//too short to hold a card at all
+    return INV_FILE;
+
+  startCardBuilder(&builder, useArena);
+
+  while (*newCardObject == NULL)//parse file unless error or the card is done
+  {
+    lineStart = *lineIndex;
+
+    if ((parseStatus = nextContentLine(vCardString, maxIndex, lineIndex, &slice)) != OK)
+      break;
+
+    if (!slice.found)//hit eof before the end flag
+    {
+      parseStatus = INV_CARD;
+      break;
+    }
+
+    if ((parseStatus = openContentLine(vCardString, &slice, &contentLine)) != OK)
+      break;
+
+    stage = builder.stage;
+    parseStatus = addCardLine(&builder, &contentLine, newCardObject);
+
+    if (parseStatus != OK && stage != EXPECT_BEGIN && beginsCard(&contentLine))//card has no END:VCARD
+      *lineIndex = lineStart;
+
+    closeContentLine(&contentLine);
+
+    if (parseStatus != OK)
+      break;
+  }
+
+  clearCardBuilder(&builder);//only does anything if the card was never finished
+
+  return parseStatus;
+}
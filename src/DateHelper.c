@@ -5,175 +5,138 @@
  * @brief File containing the helper functions needed to create a date struct
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include "VCardParser.h"
 #include "ParseHelper.h"
 #include "LinkedListAPI.h"
 #include "PropertyHelper.h"
 #include "DateHelper.h"
 
-VCardErrorCode newDate(DateTime **date, char **contentLine)
+/**
+* scanDate()
+*
+* reads the parameters and value of a BDAY/ANNIVERSARY line without allocating. Everything
+* but the text goes in to *fixed, a text value is left in the line at *textStart, *textLength
+**/
+VCardErrorCode scanDate(ContentLine *contentLine, DateTime *fixed, size_t *textStart, size_t *textLength)
 {
-  int contentIndex = 0;//keep track of current index in content line
+  const char *text = contentLine->text;
+  size_t length = contentLine->length;
   int copyStringIndex = 0;//keep track of current index in string we're making
-  int length;//keep track of contentLine length
-  int textCheckLength;
-  char *copyString;
-  DateTime *temp;//used to handle memory duing reallocs, incase malloc fails
-  DateTime *newDT;
-  List *params;
+  ParameterSlice param;
+  bool firstParam = true;
   VCardErrorCode status;
 
-  if((params = initializeList(printParameter, deleteParameter, compareParameters))==NULL)
+  //initialize elements
+  fixed->isText = 0;
+  fixed->UTC = 0;
+  strcpy(fixed->time, "\0");
+  strcpy(fixed->date,"\0");
+  *textStart = 0;
+  *textLength = 0;
+
+  while ((status = nextParameter(contentLine, &param)) == OK && param.found)//only looked at here, never kept
   {
-    *date = NULL;
-    return OTHER_ERROR;
+    //a VALUE=text first parameter makes it a text date. Like the parsed value, stop at a null
+    if (firstParam && sliceEqualIC(&(text[param.valueStart]), strnlen(&(text[param.valueStart]), param.valueLength), "text"))
+      fixed->isText = 1;
+    firstParam = false;
   }
 
-  if((status = parseParameters(&contentLine, params ))!=OK)
-  {
-    freeList(params);
-    *date = NULL;
+  if (status != OK)
     return status;
-  }
-  length = strlen(*contentLine);
 
-  if ((*contentLine)[contentIndex] != ':' && (*contentLine)[contentIndex] != ';')//unrecognized formatting
-  {
-    freeList(params);
-    *date = NULL;
+  if (contentLine->index >= length || text[contentLine->index] != ':')//unrecognized formatting
     return INV_PROP;
-  }
+  contentLine->index++;//skip over colon
 
-  if((newDT= malloc(sizeof(DateTime)+ 1))==NULL)
-  {
-    freeList(params);
-    *date = NULL;
-    return OTHER_ERROR;
-  }
-
-  if((copyString = malloc(100))==NULL)
-  {
-    freeList(params);
-    free(newDT);
-    *date = NULL;
-    return OTHER_ERROR;
-  }
-
- //initialize elements
- newDT->isText = 0;
- newDT->UTC = 0;
- strcpy(newDT->text, "\0");
- strcpy(newDT->time, "\0");
- strcpy(newDT->date,"\0");
-
- if (getLength(params) > 0)
- {
-   if (strcmpIC(((Parameter*)(params->head->data))->value, "text")==0)
-      newDT->isText = 1;
- }
-
-  freeList(params);
-
- if((*contentLine)[contentIndex] == ':')//found date values
- {
-   contentIndex++;//skip over colon
-
-  textCheckLength = contentIndex;
-  while (textCheckLength < length)
-  {
-    if (isalpha((*contentLine)[contentIndex]) && (*contentLine)[contentIndex] != 't' && (*contentLine)[contentIndex] != 'T' && (*contentLine)[contentIndex] != 'z'  && (*contentLine)[contentIndex] != 'Z' )
-      newDT->isText = 1;
-    textCheckLength++;
-  }
+  //a date can't start with a letter, other than the T of a time or the Z of UTC
+  if (contentLine->index < length && isalpha((unsigned char)text[contentLine->index]) && strchr("tTzZ", text[contentLine->index]) == NULL)
+    fixed->isText = 1;
 
-   if(newDT->isText == 1 || ((length - contentIndex))>20)//date is in text value
+   if(fixed->isText == 1 || (length - contentLine->index) > 18)//date is in text value
    {
-     newDT->isText = 1;
+     fixed->isText = 1;
 
-     //copy value data into string
-     while ((*contentLine)[contentIndex] != ':' && (*contentLine)[contentIndex] != ';' && (*contentLine)[contentIndex] != '\0' && (*contentLine)[contentIndex] != '\r')
-     {
-       copyString[copyStringIndex] = (*contentLine)[contentIndex];
-       copyStringIndex++;
-       contentIndex++;
-     }
-     copyString[copyStringIndex] = '\0';
-
-     if((temp = realloc(newDT, sizeof(DateTime) + strlen(copyString) + 1))==NULL)
-     {
-       free(newDT);
-       free(copyString);
-       return OTHER_ERROR;
-     }
-     newDT = temp;
-     strcpy(newDT->text, copyString);
-     newDT->text[copyStringIndex] = '\0';
-     free(copyString);
-     copyStringIndex = 0;
+     //find the end of the text value
+     *textStart = contentLine->index;
+     while (contentLine->index < length && text[contentLine->index] != ':' && text[contentLine->index] != ';')
+       contentLine->index++;
+     *textLength = contentLine->index - *textStart;
    }
    else//date is not in text format
    {
      //copy date
-     while ((*contentLine)[contentIndex] != 'T' && (*contentLine)[contentIndex] != 't' && (*contentLine)[contentIndex] != '\0' && (*contentLine)[contentIndex] != 'z' && (*contentLine)[contentIndex] != 'Z' && (*contentLine)[contentIndex] != '\r')
+     while (contentLine->index < length && strchr("TtZz", text[contentLine->index]) == NULL)
      {
-         newDT->date[copyStringIndex] = (*contentLine)[contentIndex];
-         contentIndex++;
-         copyStringIndex++;
+       if (copyStringIndex == sizeof(fixed->date) - 1)//longer than YYYYMMDD
+         return INV_DT;
+       fixed->date[copyStringIndex] = text[contentLine->index];
+       contentLine->index++;
+       copyStringIndex++;
      }
-     newDT->date[copyStringIndex] = '\0';
+     fixed->date[copyStringIndex] = '\0';
      copyStringIndex = 0;
 
-     if ((*contentLine)[contentIndex] == 'T' || (*contentLine)[contentIndex] == 't')//foud time entry
+     if (contentLine->index < length && (text[contentLine->index] == 'T' || text[contentLine->index] == 't'))//foud time entry
      {
-       contentIndex++;//step over t
+       contentLine->index++;//step over t
 
-       while(copyStringIndex < 6 && (*contentLine)[contentIndex] != '\0' && (*contentLine)[contentIndex] != 'Z' && (*contentLine)[contentIndex] != 'z')
+       while(copyStringIndex < 6 && contentLine->index < length && text[contentLine->index] != 'Z' && text[contentLine->index] != 'z')
        {
-         if ((*contentLine)[contentIndex] == '-')//dashes in input mean two (2) dashes in date string
+         if (text[contentLine->index] == '-')//dashes in input mean two (2) dashes in date string
          {
-           newDT->time[copyStringIndex] = '-';
+           fixed->time[copyStringIndex] = '-';
            copyStringIndex++;
            if (copyStringIndex < 6)//make sure there's room for last dash
            {
-             newDT->time[copyStringIndex] = '-';
+             fixed->time[copyStringIndex] = '-';
              copyStringIndex++;
            }
-           contentIndex++;
+           contentLine->index++;
          }
          else
          {
-           newDT->time[copyStringIndex] = (*contentLine)[contentIndex];
+           fixed->time[copyStringIndex] = text[contentLine->index];
            copyStringIndex++;
-           contentIndex++;
+           contentLine->index++;
          }
        }
-       newDT->time[copyStringIndex] = '\0';
+       fixed->time[copyStringIndex] = '\0';
      }
 
-     if ((*contentLine)[contentIndex] == 'z' || (*contentLine)[contentIndex] == 'Z')//foud time entry
+     if (contentLine->index < length && (text[contentLine->index] == 'z' || text[contentLine->index] == 'Z'))//foud time entry
      {
-       newDT->UTC = 1;
+       fixed->UTC = 1;
      }
-
-     free(copyString);
    }
- }
- else//invalid syntax
- {
-   free(newDT);
-   *date = NULL;
-   return INV_PROP;
- }
-
-
- if (newDT->isText == 1 && strcmp(newDT->time, "\0")!= 0 && strcmp(newDT->date, "\0")!= 0)
- {
-    free(newDT);
-    *date = NULL;
-    return INV_PROP;
-  }
 
+  return OK;
+}
+
+VCardErrorCode newDate(DateTime **date, ContentLine *contentLine, CardArena *arena)
+{
+  DateTime fixed;//everything but the text
+  size_t textStart, textLength;
+  DateTime *newDT;
+  VCardErrorCode status;
+
+  *date = NULL;
+
+  if ((status = scanDate(contentLine, &fixed, &textStart, &textLength)) != OK)
+    return status;
+
+  if((newDT = allocFrom(arena, sizeof(DateTime) + textLength + 1))==NULL)
+    return OTHER_ERROR;
+
+  newDT->isText = fixed.isText;
+  newDT->UTC = fixed.UTC;
+  memcpy(newDT->date, fixed.date, sizeof(fixed.date));
+  memcpy(newDT->time, fixed.time, sizeof(fixed.time));
+  memcpy(newDT->text, &(contentLine->text[textStart]), textLength);
+  newDT->text[textLength] = '\0';
 
- *date = newDT;
- return OK;
+  *date = newDT;
+  return OK;
 }
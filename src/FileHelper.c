@@ -0,0 +1,240 @@
+/**
+ * @file FileHelper.c
+ * @author Kevin ioi
+ * @date Sept 2018
+ * @brief File containing the helper functions used to bring an entire vcf file in to memory,
+ *        mapping it when possible and reading it in to one buffer otherwise (pipes, fifos),
+ *        or to wrap a caller's buffer the same way
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "VCardParser.h"
+#include "FileHelper.h"
+
+/**
+* validFileExtension()
+*
+* true if fileName ends in .vcf or .vcard
+**/
+bool validFileExtension(const char *fileName)
+{
+  size_t length;
+
+  if (fileName == NULL)
+    return false;
+
+  length = strlen(fileName);
+
+  if (length >= 3 && strcmp(&(fileName[length - 3]), "vcf") == 0)
+    return true;
+  if (length >= 5 && strcmp(&(fileName[length - 5]), "vcard") == 0)
+    return true;
+
+  return false;
+}
+
+/**
+* readExact()
+*
+* read size bytes from a regular file in to one buffer of exactly that size
+**/
+static VCardErrorCode readExact(int fd, size_t size, VCardBuffer *buffer)
+{
+  char *contents;
+  size_t bytesRead = 0;
+  ssize_t chunk;
+
+  if ((contents = malloc(size)) == NULL)
+    return OTHER_ERROR;
+
+  while (bytesRead < size)
+  {
+    chunk = read(fd, contents + bytesRead, size - bytesRead);
+
+    if (chunk < 0 && errno == EINTR)
+      continue;
+    if (chunk < 0)
+    {
+      free(contents);
+      return INV_FILE;
+    }
+    if (chunk == 0)//file shrank while we were reading it
+      break;
+
+    bytesRead += chunk;
+  }
+
+  buffer->data = contents;
+  buffer->length = bytesRead;
+  buffer->mapped = false;
+  buffer->borrowed = false;
+
+  return OK;
+}
+
+/**
+* readVCardFd()
+*
+* read everything left on fd (pipe, fifo, socket) in to a single heap buffer.
+* the buffer grows geometrically and is trimmed to the exact size at eof
+**/
+VCardErrorCode readVCardFd(int fd, VCardBuffer *buffer)
+{
+  char *contents;
+  char *temp;//guard against realloc failure
+  size_t memSize = 4096, bytesRead = 0;
+  ssize_t chunk;
+
+  if (buffer == NULL)
+    return OTHER_ERROR;
+
+  if ((contents = malloc(memSize)) == NULL)
+    return OTHER_ERROR;
+
+  while ((chunk = read(fd, contents + bytesRead, memSize - bytesRead)) != 0)
+  {
+    if (chunk < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      free(contents);
+      return INV_FILE;
+    }
+
+    bytesRead += chunk;
+
+    if (bytesRead == memSize)//out of room, double it
+    {
+      if ((temp = realloc(contents, memSize * 2)) == NULL)
+      {
+        free(contents);
+        return OTHER_ERROR;
+      }
+      contents = temp;
+      memSize *= 2;
+    }
+  }
+
+  if (bytesRead == 0)
+  {
+    free(contents);
+    contents = NULL;
+  }
+  else if ((temp = realloc(contents, bytesRead)) != NULL)//trim to exact size
+  {
+    contents = temp;
+  }
+
+  buffer->data = contents;
+  buffer->length = bytesRead;
+  buffer->mapped = false;
+  buffer->borrowed = false;
+
+  return OK;
+}
+
+/**
+* mapVCardFile()
+*
+* make the whole file visible as one read-only byte range. regular files are
+* mmap'd, anything that can't be mapped is read in to one buffer instead
+**/
+VCardErrorCode mapVCardFile(const char *fileName, VCardBuffer *buffer)
+{
+  int fd;
+  struct stat fileInfo;
+  void *region;
+  VCardErrorCode status;
+
+  if (buffer == NULL)
+    return OTHER_ERROR;
+
+  buffer->data = NULL;
+  buffer->length = 0;
+  buffer->mapped = false;
+  buffer->borrowed = false;
+
+  if (!validFileExtension(fileName))
+    return INV_FILE;
+
+  if ((fd = open(fileName, O_RDONLY)) < 0)
+    return INV_FILE;
+
+  if (fstat(fd, &fileInfo) != 0)
+  {
+    close(fd);
+    return INV_FILE;
+  }
+
+  if (!S_ISREG(fileInfo.st_mode))//pipe or fifo, size isn't known up front
+  {
+    status = readVCardFd(fd, buffer);
+    close(fd);
+    return status;
+  }
+
+  if (fileInfo.st_size == 0)//nothing to map
+  {
+    close(fd);
+    return OK;
+  }
+
+  region = mmap(NULL, fileInfo.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  if (region == MAP_FAILED)//fall back to reading it in
+  {
+    status = readExact(fd, fileInfo.st_size, buffer);
+    close(fd);
+    return status;
+  }
+
+  posix_madvise(region, fileInfo.st_size, POSIX_MADV_SEQUENTIAL);
+  close(fd);//mapping stays valid after the descriptor is closed
+
+  buffer->data = region;
+  buffer->length = fileInfo.st_size;
+  buffer->mapped = true;
+  buffer->borrowed = false;
+
+  return OK;
+}
+
+/**
+* unmapVCardFile()
+*
+**/
+void unmapVCardFile(VCardBuffer *buffer)
+{
+  if (buffer == NULL || buffer->data == NULL)
+    return;
+
+  if (buffer->mapped)
+    munmap((void*)buffer->data, buffer->length);
+  else if (!buffer->borrowed)//borrowed memory still belongs to the caller
+    free((void*)buffer->data);
+
+  buffer->data = NULL;
+  buffer->length = 0;
+  buffer->mapped = false;
+  buffer->borrowed = false;
+}
+
+/**
+* borrowVCardBuffer()
+*
+* wrap caller owned memory so it can be parsed like a mapped file
+**/
+void borrowVCardBuffer(const char *data, size_t length, VCardBuffer *buffer)
+{
+  buffer->data = data;
+  buffer->length = data == NULL ? 0 : length;
+  buffer->mapped = false;
+  buffer->borrowed = true;
+}
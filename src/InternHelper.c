@@ -0,0 +1,308 @@
+/**
+ * @file InternHelper.c
+ * @author Kevin ioi
+ * @date Oct 2018
+ * @brief File containing the process wide table of interned names. A contact book repeats the
+ *        same few dozen property and parameter names (TEL, EMAIL, TYPE, ...) on every card, so
+ *        each name is stored once and every Property/Parameter points at that copy. The table
+ *        is split in to shards with a lock each so parser threads rarely wait on each other.
+ *        Interned names live until the process exits
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "InternHelper.h"
+
+#define INTERN_SHARDS 16
+
+//each shard stops taking new names once it holds this many, so a file full of made up
+//X- names can't grow the table forever. Later names just get their own copy
+#define INTERN_SHARD_NAMES 4096
+
+//names are packed in to chunks of this size, each one aligned to its size
+#define INTERN_CHUNK 4096
+
+//a chunk holds at least INTERN_CHUNK / INTERN_MAX_LENGTH names, so the shards can't fill
+//more than about 3300 chunks between them. Twice that keeps probes short
+#define INTERN_CHUNK_SLOTS 8192
+
+/*
+  Open addressing hash set of names, guarded by lock
+*/
+typedef struct internShard {
+  pthread_mutex_t lock;
+
+  //capacity slots, each NULL or an interned name. hashes[i] is the hash of slots[i]
+  const char      **slots;
+  uint32_t        *hashes;
+  size_t          count;
+  size_t          capacity;
+
+  //where the next name is copied to
+  char            *chunk;
+  size_t          chunkUsed;
+} InternShard;
+
+static InternShard shards[INTERN_SHARDS];
+static pthread_once_t shardsReady = PTHREAD_ONCE_INIT;
+
+//address of every chunk ever made, 0 for an empty slot. Chunks are never freed and slots
+//are only ever filled, so looking a chunk up needs no lock
+static _Atomic uintptr_t chunkSlots[INTERN_CHUNK_SLOTS];
+
+/**
+* initShards()
+*
+**/
+static void initShards(void)
+{
+  int i;
+
+  for (i = 0; i < INTERN_SHARDS; i++)
+  {
+    pthread_mutex_init(&shards[i].lock, NULL);
+    shards[i].slots = NULL;
+    shards[i].hashes = NULL;
+    shards[i].count = 0;
+    shards[i].capacity = 0;
+    shards[i].chunk = NULL;
+    shards[i].chunkUsed = INTERN_CHUNK;
+  }
+}
+
+/**
+* hashName()
+*
+* FNV-1a, the low bits pick the shard and the rest pick the slot
+**/
+static uint32_t hashName(const char *name, size_t length)
+{
+  uint32_t hash = 2166136261u;
+  size_t i;
+
+  for (i = 0; i < length; i++)
+  {
+    hash ^= (unsigned char)name[i];
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+/**
+* findSlot()
+*
+* index of the slot holding the name, or of the empty slot it would go in
+**/
+static size_t findSlot(const char **slots, const uint32_t *hashes, size_t capacity, const char *name, size_t length, uint32_t hash)
+{
+  size_t i = (hash / INTERN_SHARDS) & (capacity - 1);
+
+  while (slots[i] != NULL)
+  {
+    if (hashes[i] == hash && strncmp(slots[i], name, length) == 0 && slots[i][length] == '\0')
+      return i;
+    i = (i + 1) & (capacity - 1);
+  }
+
+  return i;
+}
+
+/**
+* growShard()
+*
+* double the slot arrays, the names themselves don't move
+**/
+static bool growShard(InternShard *shard)
+{
+  size_t capacity = shard->capacity == 0 ? 64 : shard->capacity * 2;
+  const char **slots = calloc(capacity, sizeof(char*));
+  uint32_t *hashes = malloc(capacity * sizeof(uint32_t));
+  size_t i, slot;
+
+  if (slots == NULL || hashes == NULL)
+  {
+    free(slots);
+    free(hashes);
+    return false;
+  }
+
+  for (i = 0; i < shard->capacity; i++)
+  {
+    if (shard->slots[i] != NULL)
+    {
+      slot = findSlot(slots, hashes, capacity, shard->slots[i], strlen(shard->slots[i]), shard->hashes[i]);
+      slots[slot] = shard->slots[i];
+      hashes[slot] = shard->hashes[i];
+    }
+  }
+
+  free(shard->slots);
+  free(shard->hashes);
+  shard->slots = slots;
+  shard->hashes = hashes;
+  shard->capacity = capacity;
+
+  return true;
+}
+
+/**
+* addChunk()
+*
+* record a new chunk so isInterned can find it, false if the table is somehow full
+**/
+static bool addChunk(uintptr_t chunk)
+{
+  size_t i = (chunk / INTERN_CHUNK) & (INTERN_CHUNK_SLOTS - 1), tries;
+  uintptr_t empty;
+
+  for (tries = 0; tries < INTERN_CHUNK_SLOTS; tries++)
+  {
+    empty = 0;
+    if (atomic_compare_exchange_strong(&chunkSlots[i], &empty, chunk))
+      return true;
+    i = (i + 1) & (INTERN_CHUNK_SLOTS - 1);
+  }
+
+  return false;
+}
+
+/**
+* storeName()
+*
+* copy a name in to the shard's current chunk, starting a new chunk when it is full
+**/
+static const char *storeName(InternShard *shard, const char *name, size_t length)
+{
+  char *copy, *chunk;
+
+  if (INTERN_CHUNK - shard->chunkUsed < length + 1)
+  {
+    //the old chunk is still referenced by the names in it, it is never freed
+    if ((chunk = aligned_alloc(INTERN_CHUNK, INTERN_CHUNK)) == NULL)
+      return NULL;
+
+    if (!addChunk((uintptr_t)chunk))
+    {
+      free(chunk);
+      return NULL;
+    }
+
+    shard->chunk = chunk;
+    shard->chunkUsed = 0;
+  }
+
+  copy = &(shard->chunk[shard->chunkUsed]);
+  memcpy(copy, name, length);
+  copy[length] = '\0';
+  shard->chunkUsed += length + 1;
+
+  return copy;
+}
+
+/**
+* internSlice()
+*
+* the one shared copy of slice[0..length), added to the table if it isn't there yet.
+* NULL if the name is too long to intern, the table is full, or memory ran out
+**/
+const char *internSlice(const char *slice, size_t length)
+{
+  InternShard *shard;
+  const char *interned = NULL;
+  uint32_t hash;
+  size_t slot;
+
+  if (slice == NULL || length >= INTERN_MAX_LENGTH || memchr(slice, '\0', length) != NULL)
+    return NULL;
+
+  pthread_once(&shardsReady, initShards);
+
+  hash = hashName(slice, length);
+  shard = &shards[hash % INTERN_SHARDS];
+
+  pthread_mutex_lock(&shard->lock);
+
+  if (shard->capacity > 0)
+  {
+    slot = findSlot(shard->slots, shard->hashes, shard->capacity, slice, length, hash);
+    interned = shard->slots[slot];
+  }
+
+  if (interned == NULL && shard->count < INTERN_SHARD_NAMES)
+  {
+    if (shard->count * 4 >= shard->capacity * 3 && !growShard(shard))//keep the load under 3/4
+    {
+      pthread_mutex_unlock(&shard->lock);
+      return NULL;
+    }
+
+    if ((interned = storeName(shard, slice, length)) != NULL)
+    {
+      slot = findSlot(shard->slots, shard->hashes, shard->capacity, slice, length, hash);
+      shard->slots[slot] = interned;
+      shard->hashes[slot] = hash;
+      shard->count++;
+    }
+  }
+
+  pthread_mutex_unlock(&shard->lock);
+
+  return interned;
+}
+
+/**
+* isInterned()
+*
+* true if string is the shared copy from the table (not just equal to it). Only interned
+* names are ever put in chunks, so that is the case if the chunk around string is one of
+* ours. No hashing or locking, freeName calls this for every name it is given
+**/
+bool isInterned(const char *string)
+{
+  uintptr_t chunk = (uintptr_t)string & ~(uintptr_t)(INTERN_CHUNK - 1), slot;
+  size_t i = (chunk / INTERN_CHUNK) & (INTERN_CHUNK_SLOTS - 1), tries;
+
+  if (string == NULL)
+    return false;
+
+  for (tries = 0; tries < INTERN_CHUNK_SLOTS && (slot = atomic_load(&chunkSlots[i])) != 0; tries++)
+  {
+    if (slot == chunk)
+      return true;
+    i = (i + 1) & (INTERN_CHUNK_SLOTS - 1);
+  }
+
+  return false;
+}
+
+/**
+* internOrCopy()
+*
+* the interned name if it can be interned, otherwise a copy of its own (from arena when
+* it isn't NULL). Either way the result is released with freeName, or with the arena
+**/
+char *internOrCopy(CardArena *arena, const char *slice, size_t length)
+{
+  const char *interned;
+
+  if ((interned = internSlice(slice, length)) != NULL)
+    return (char*)interned;
+
+  return copySliceFrom(arena, slice, length);
+}
+
+/**
+* freeName()
+*
+* free a name from internOrCopy, or a plain malloc'd one. Interned names are left alone
+**/
+void freeName(void *name)
+{
+  if (name != NULL && !isInterned(name))
+    free(name);
+}
@@ -0,0 +1,286 @@
+/**
+ * @file JSONHelper.c
+ * @author Kevin ioi
+ * @date Oct 2018
+ * @brief File containing the JSON writer behind strListToJSON, propToJSON, dtToJSON and
+ *        cardToJSON. Each structure is appended to one OutBuffer in a single pass, strings are
+ *        escaped a run at a time, and the caller gets the buffer itself back as the JSON
+ *        string. The NDJSON export reuses one buffer for a whole stream of cards
+ */
+
+#include "VCardParser.h"
+#include "LinkedListAPI.h"
+#include "WriteCardHelper.h"
+#include "FileHelper.h"
+#include "JSONHelper.h"
+
+//append a string literal without measuring it at run time
+#define appendLiteral(out, literal) appendBytes(out, literal, sizeof(literal) - 1)
+
+//NDJSON output is handed to the file each time this much has built up
+#define NDJSON_FLUSH 65536
+
+static const char hexDigits[] = "0123456789abcdef";
+
+/**
+* needsEscape()
+*
+* true for the bytes JSON won't take raw in a string: quote, backslash and control chars
+**/
+static bool needsEscape(unsigned char c)
+{
+  return c < 0x20 || c == '\"' || c == '\\';
+}
+
+/**
+* writeEscape()
+*
+* the escape sequence for one byte needsEscape() said no to, at most 6 bytes. Returns its length
+**/
+static size_t writeEscape(char *dest, unsigned char c)
+{
+  char shortEscape;
+
+  switch (c)
+  {
+    case '\"': shortEscape = '\"'; break;
+    case '\\': shortEscape = '\\'; break;
+    case '\n': shortEscape = 'n'; break;
+    case '\r': shortEscape = 'r'; break;
+    case '\t': shortEscape = 't'; break;
+    case '\b': shortEscape = 'b'; break;
+    case '\f': shortEscape = 'f'; break;
+    default://\u00XX
+      memcpy(dest, "\\u00", 4);
+      dest[4] = hexDigits[c >> 4];
+      dest[5] = hexDigits[c & 0xF];
+      return 6;
+  }
+
+  dest[0] = '\\';
+  dest[1] = shortEscape;
+  return 2;
+}
+
+/**
+* appendJSONString()
+*
+* string in quotes. Room for the string as it is is reserved once, runs of bytes that need
+* no escaping (nearly all of any real value) are copied straight in, and only an escape
+* has to ask for more room
+**/
+bool appendJSONString(OutBuffer *out, const char *string)
+{
+  const char *run, *end;
+  size_t length;
+
+  if (string == NULL)
+    string = "";
+
+  length = strlen(string);
+  end = string + length;
+  if (!reserveBytes(out, length + 2))
+    return false;
+
+  out->data[out->length++] = '\"';
+
+  while (*string != '\0')
+  {
+    run = string;
+    while (*string != '\0' && !needsEscape((unsigned char)*string))
+      string++;
+
+    memcpy(&(out->data[out->length]), run, string - run);
+    out->length += string - run;
+
+    if (*string != '\0')
+    {
+      //the escape is at most 6 bytes where the string had 1, plus the closing quote
+      if (!reserveBytes(out, 6 + (end - string)))
+        return false;
+      out->length += writeEscape(&(out->data[out->length]), (unsigned char)*(string++));
+    }
+  }
+
+  out->data[out->length++] = '\"';
+
+  return true;
+}
+
+/**
+* appendJSONStrList()
+*
+* ["value","value",...]
+**/
+bool appendJSONStrList(OutBuffer *out, const List *strList)
+{
+  ListIterator iter = createIterator((List*)strList);
+  char *value;
+  bool ok, first = true;
+
+  ok = appendBytes(out, "[", 1);
+
+  while (ok && (value = (char*)nextElement(&iter)) != NULL)
+  {
+    ok = (first || appendBytes(out, ",", 1)) && appendJSONString(out, value);
+    first = false;
+  }
+
+  return ok && appendBytes(out, "]", 1);
+}
+
+/**
+* appendJSONParameters()
+*
+* [{"name":"","value":""},...]
+**/
+static bool appendJSONParameters(OutBuffer *out, const List *parameters)
+{
+  ListIterator iter = createIterator((List*)parameters);
+  Parameter *param;
+  bool ok, first = true;
+
+  ok = appendBytes(out, "[", 1);
+
+  while (ok && (param = (Parameter*)nextElement(&iter)) != NULL)
+  {
+    ok = (first || appendBytes(out, ",", 1)) && appendLiteral(out, "{\"name\":") &&
+         appendJSONString(out, param->name) && appendLiteral(out, ",\"value\":") &&
+         appendJSONString(out, param->value) && appendBytes(out, "}", 1);
+    first = false;
+  }
+
+  return ok && appendBytes(out, "]", 1);
+}
+
+/**
+* appendJSONProperty()
+*
+* {"group":"","name":"","values":[]}. propToJSON leaves parameters out, a whole card
+* needs them so it adds "parameters":[] before the values. No property is null
+**/
+bool appendJSONProperty(OutBuffer *out, const Property *prop, bool withParameters)
+{
+  if (prop == NULL)
+    return appendLiteral(out, "null");
+
+  return appendLiteral(out, "{\"group\":") && appendJSONString(out, prop->group) &&
+         appendLiteral(out, ",\"name\":") && appendJSONString(out, prop->name) &&
+         (!withParameters || (appendLiteral(out, ",\"parameters\":") && appendJSONParameters(out, prop->parameters))) &&
+         appendLiteral(out, ",\"values\":") && appendJSONStrList(out, prop->values) &&
+         appendBytes(out, "}", 1);
+}
+
+/**
+* appendJSONDateTime()
+*
+* {"isText":,"date":"","time":"","text":"","isUTC":}, a text date always has isUTC false.
+* No date is null
+**/
+bool appendJSONDateTime(OutBuffer *out, const DateTime *date)
+{
+  if (date == NULL)
+    return appendLiteral(out, "null");
+
+  if (date->isText)
+    return appendLiteral(out, "{\"isText\":true,\"date\":\"\",\"time\":\"\",\"text\":") &&
+           appendJSONString(out, date->text) && appendLiteral(out, ",\"isUTC\":false}");
+
+  return appendLiteral(out, "{\"isText\":false,\"date\":") && appendJSONString(out, date->date) &&
+         appendLiteral(out, ",\"time\":") && appendJSONString(out, date->time) &&
+         appendLiteral(out, ",\"text\":\"\",\"isUTC\":") && (date->UTC ? appendLiteral(out, "true}") : appendLiteral(out, "false}"));
+}
+
+/**
+* appendJSONCard()
+*
+* {"fn":{},"optionalProperties":[],"birthday":{},"anniversary":{}}, with every property's
+* parameters so nothing on the card is lost
+**/
+bool appendJSONCard(OutBuffer *out, const Card *card)
+{
+  ListIterator iter = createIterator(card->optionalProperties);
+  Property *prop;
+  bool ok, first = true;
+
+  ok = appendLiteral(out, "{\"fn\":") && appendJSONProperty(out, card->fn, true) &&
+       appendLiteral(out, ",\"optionalProperties\":[");
+
+  while (ok && (prop = (Property*)nextElement(&iter)) != NULL)
+  {
+    ok = (first || appendBytes(out, ",", 1)) && appendJSONProperty(out, prop, true);
+    first = false;
+  }
+
+  return ok && appendLiteral(out, "],\"birthday\":") && appendJSONDateTime(out, card->birthday) &&
+         appendLiteral(out, ",\"anniversary\":") && appendJSONDateTime(out, card->anniversary) &&
+         appendBytes(out, "}", 1);
+}
+
+/**
+* finishJSON()
+*
+* NUL terminate out and hand its data over as the JSON string, NULL if that fails
+**/
+char *finishJSON(OutBuffer *out)
+{
+  char *json;
+
+  if (!appendBytes(out, "", 1))
+  {
+    freeOutBuffer(out);
+    return NULL;
+  }
+
+  json = out->data;
+  out->data = NULL;
+  freeOutBuffer(out);
+
+  return json;
+}
+
+/**
+* writeNDJSON()
+*
+* every card left in stream as one JSON object per line on fd. Only one card is held at a
+* time and the text goes out every NDJSON_FLUSH bytes, so memory doesn't grow with the file.
+* Invalid cards are skipped and the first one's error returned at the end, a failed write
+* stops the export
+**/
+VCardErrorCode writeNDJSON(int fd, CardStream *stream)
+{
+  VCardErrorCode parseStatus, firstError = OK;
+  OutBuffer out;
+  Card *card;
+  bool ok;
+
+  if (!startOutBuffer(&out, NDJSON_FLUSH + 4096))//room for the last card to spill over
+    return OTHER_ERROR;
+
+  while (true)
+  {
+    if ((parseStatus = nextCard(stream, &card)) != OK)
+    {
+      if (firstError == OK)
+        firstError = parseStatus;
+      continue;
+    }
+
+    if (card == NULL)//end of the stream
+      break;
+
+    ok = appendJSONCard(&out, card) && appendBytes(&out, "\n", 1);
+    deleteCard(card);
+
+    if (!ok || (out.length >= NDJSON_FLUSH && flushOutBuffer(fd, &out) != OK))
+    {
+      freeOutBuffer(&out);
+      return WRITE_ERROR;
+    }
+  }
+
+  parseStatus = flushOutBuffer(fd, &out);
+  freeOutBuffer(&out);
+
+  return parseStatus != OK ? parseStatus : firstError;
+}
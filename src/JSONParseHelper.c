@@ -0,0 +1,881 @@
+/**
+ * @file JSONParseHelper.c
+ * @author Kevin ioi
+ * @date Oct 2018
+ * @brief File containing the JSON tokenizer behind JSONtoStrList, JSONtoProp, JSONtoDT and
+ *        the card readers. Text is tokenized once, front to back, tokens point in to the
+ *        text instead of being copied, and strings are scanned for their closing quote a
+ *        block at a time. Keys may come in any order, unknown keys are skipped
+ */
+
+#include "VCardParser.h"
+#include "LinkedListAPI.h"
+#include "ParseHelper.h"
+#include "CardHelper.h"
+#include "ScanHelper.h"
+#include "InternHelper.h"
+#include "JSONParseHelper.h"
+
+//objects and arrays nested deeper than this are rejected when skipping a value
+#define JSON_MAX_DEPTH 64
+
+//strings are checked a char at a time for this long before a block scan takes over. Most
+//keys and values end sooner, and for them setting up the block scan costs more than it saves
+#define JSON_SHORT_STRING 32
+
+/**
+* startJSONReader()
+*
+**/
+void startJSONReader(JSONReader *reader, const char *text, size_t length)
+{
+  reader->text = text;
+  reader->length = length;
+  reader->index = 0;
+}
+
+/**
+* isJSONSpace()
+*
+**/
+static bool isJSONSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+/**
+* hexValue()
+*
+* value of one hex digit, -1 if it isn't one
+**/
+static int hexValue(char c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+
+  return -1;
+}
+
+/**
+* scanJSONString()
+*
+* string token starting just after its opening quote at index. Only quotes and backslashes
+* stop the scan, so long runs of plain text go by a block at a time
+**/
+static bool scanJSONString(JSONReader *reader, size_t index, JSONToken *token)
+{
+  const char *text = reader->text;
+  size_t length = reader->length, stop;
+  int i;
+
+  token->type = JSON_STRING;
+  token->start = &text[index];
+  token->escaped = false;
+
+  while (true)
+  {
+    stop = length - index > JSON_SHORT_STRING ? index + JSON_SHORT_STRING : length;
+    while (index < stop && text[index] != '\"' && text[index] != '\\')
+      index++;
+
+    if (index == stop && stop < length)//long string, scan the rest a block at a time
+      index += scanFor(&text[index], length - index, SCAN_QUOTE | SCAN_BACKSLASH);
+
+    if (index >= length)//no closing quote
+      break;
+
+    if (text[index] == '\"')
+    {
+      token->length = &text[index] - token->start;
+      reader->index = index + 1;
+      return true;
+    }
+
+    token->escaped = true;
+    if (index + 1 >= length)
+      break;
+
+    if (text[index+1] == 'u')//\uXXXX
+    {
+      if (length - index < 6)
+        break;
+      for (i = 2; i < 6 && hexValue(text[index+i]) >= 0; i++);
+      if (i < 6)
+        break;
+      index += 6;
+    }
+    else if (strchr("\"\\/bfnrt", text[index+1]) != NULL && text[index+1] != '\0')
+    {
+      index += 2;
+    }
+    else//not an escape JSON has
+    {
+      break;
+    }
+  }
+
+  token->type = JSON_BAD;
+  return false;
+}
+
+/**
+* nextJSONToken()
+*
+* the next token, JSON_END once only whitespace is left. False (and a JSON_BAD token) if the
+* text isn't JSON
+**/
+bool nextJSONToken(JSONReader *reader, JSONToken *token)
+{
+  const char *text = reader->text;
+  size_t index = reader->index, length = reader->length;
+
+  while (index < length && isJSONSpace(text[index]))
+    index++;
+
+  token->start = &text[index];
+  token->length = 1;
+  token->escaped = false;
+  reader->index = index + 1;
+
+  if (index == length)
+  {
+    token->type = JSON_END;
+    token->length = 0;
+    reader->index = index;
+    return true;
+  }
+
+  switch (text[index])
+  {
+    case '{': token->type = JSON_OBJECT; return true;
+    case '}': token->type = JSON_OBJECT_END; return true;
+    case '[': token->type = JSON_ARRAY; return true;
+    case ']': token->type = JSON_ARRAY_END; return true;
+    case ':': token->type = JSON_COLON; return true;
+    case ',': token->type = JSON_COMMA; return true;
+    case '\"': return scanJSONString(reader, index + 1, token);
+    default: break;
+  }
+
+  if (length - index >= 4 && memcmp(&text[index], "true", 4) == 0)
+    token->type = JSON_TRUE;
+  else if (length - index >= 5 && memcmp(&text[index], "false", 5) == 0)
+    token->type = JSON_FALSE;
+  else if (length - index >= 4 && memcmp(&text[index], "null", 4) == 0)
+    token->type = JSON_NULL;
+  else if (text[index] == '-' || (text[index] >= '0' && text[index] <= '9'))
+    token->type = JSON_NUMBER;
+  else
+  {
+    token->type = JSON_BAD;
+    return false;
+  }
+
+  if (token->type == JSON_NUMBER)//nothing here stores numbers, only their extent matters
+  {
+    while (index + token->length < length && strchr("+-.eE0123456789", text[index + token->length]) != NULL &&
+           text[index + token->length] != '\0')
+      token->length++;
+  }
+  else
+  {
+    token->length = token->type == JSON_FALSE ? 5 : 4;
+  }
+
+  reader->index = index + token->length;
+
+  return true;
+}
+
+/**
+* atJSONEnd()
+*
+* true if nothing but whitespace is left
+**/
+bool atJSONEnd(JSONReader *reader)
+{
+  JSONToken token;
+
+  return nextJSONToken(reader, &token) && token.type == JSON_END;
+}
+
+/**
+* nextJSONMember()
+*
+* the next "key":value of an object whose { has been read. value is the first token of the
+* value, an object or array value still has to be read (or skipped) by the caller. first
+* starts out true and is kept up to date here
+**/
+JSONItem nextJSONMember(JSONReader *reader, bool *first, JSONToken *key, JSONToken *value)
+{
+  JSONToken token;
+
+  if (!nextJSONToken(reader, key))
+    return JSON_INVALID;
+
+  if (key->type == JSON_OBJECT_END)
+    return JSON_DONE;
+
+  if (!*first && (key->type != JSON_COMMA || !nextJSONToken(reader, key)))
+    return JSON_INVALID;
+  *first = false;
+
+  if (key->type != JSON_STRING || !nextJSONToken(reader, &token) || token.type != JSON_COLON)
+    return JSON_INVALID;
+
+  if (!nextJSONToken(reader, value) || value->type == JSON_END || value->type == JSON_COLON ||
+      value->type == JSON_COMMA || value->type == JSON_OBJECT_END || value->type == JSON_ARRAY_END)
+    return JSON_INVALID;
+
+  return JSON_ITEM;
+}
+
+/**
+* nextJSONElement()
+*
+* the next value of an array whose [ has been read, same rules as nextJSONMember()
+**/
+JSONItem nextJSONElement(JSONReader *reader, bool *first, JSONToken *value)
+{
+  if (!nextJSONToken(reader, value))
+    return JSON_INVALID;
+
+  if (value->type == JSON_ARRAY_END)
+    return JSON_DONE;
+
+  if (!*first && (value->type != JSON_COMMA || !nextJSONToken(reader, value)))
+    return JSON_INVALID;
+  *first = false;
+
+  if (value->type == JSON_END || value->type == JSON_COLON || value->type == JSON_COMMA ||
+      value->type == JSON_OBJECT_END || value->type == JSON_ARRAY_END)
+    return JSON_INVALID;
+
+  return JSON_ITEM;
+}
+
+/**
+* skipJSONValue()
+*
+* step over a value nothing is wanted from, first being its first token. Nesting is tracked
+* with a bit per level instead of recursion, so deep input can't run the stack out
+**/
+bool skipJSONValue(JSONReader *reader, const JSONToken *first)
+{
+  JSONToken token;
+  uint64_t objects = 0;//bit i set if level i is an object
+  int depth = 0;
+
+  if (first->type != JSON_OBJECT && first->type != JSON_ARRAY)
+    return true;
+
+  token = *first;
+
+  do
+  {
+    if (token.type == JSON_OBJECT || token.type == JSON_ARRAY)
+    {
+      if (depth == JSON_MAX_DEPTH)
+        return false;
+      objects = (objects & ~((uint64_t)1 << depth)) | ((uint64_t)(token.type == JSON_OBJECT) << depth);
+      depth++;
+    }
+    else if (token.type == JSON_OBJECT_END || token.type == JSON_ARRAY_END)
+    {
+      depth--;
+      if (((objects >> depth) & 1) != (token.type == JSON_OBJECT_END))//] closing a { or the other way round
+        return false;
+    }
+
+    if (depth > 0 && (!nextJSONToken(reader, &token) || token.type == JSON_END))
+      return false;
+  } while (depth > 0);
+
+  return true;
+}
+
+/**
+* appendUTF8()
+*
+* code point as UTF-8, returns how many bytes that took
+**/
+static size_t appendUTF8(char *dest, unsigned long code)
+{
+  if (code < 0x80)
+  {
+    dest[0] = (char)code;
+    return 1;
+  }
+  if (code < 0x800)
+  {
+    dest[0] = (char)(0xC0 | (code >> 6));
+    dest[1] = (char)(0x80 | (code & 0x3F));
+    return 2;
+  }
+  if (code < 0x10000)
+  {
+    dest[0] = (char)(0xE0 | (code >> 12));
+    dest[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+    dest[2] = (char)(0x80 | (code & 0x3F));
+    return 3;
+  }
+
+  dest[0] = (char)(0xF0 | (code >> 18));
+  dest[1] = (char)(0x80 | ((code >> 12) & 0x3F));
+  dest[2] = (char)(0x80 | ((code >> 6) & 0x3F));
+  dest[3] = (char)(0x80 | (code & 0x3F));
+  return 4;
+}
+
+/**
+* readHex4()
+*
+* the 4 hex digits at text, already checked by the tokenizer
+**/
+static unsigned long readHex4(const char *text)
+{
+  return (unsigned long)((hexValue(text[0]) << 12) | (hexValue(text[1]) << 8) | (hexValue(text[2]) << 4) | hexValue(text[3]));
+}
+
+/**
+* decodeJSONString()
+*
+* the string token with its escapes undone, null terminated. No escape decodes to more
+* bytes than it is written with, so dest needs token->length + 1 bytes. A string can't
+* hold \u0000 or a lone surrogate, both become U+FFFD
+**/
+static size_t decodeJSONString(const JSONToken *token, char *dest)
+{
+  const char *text = token->start, *end = token->start + token->length, *run;
+  size_t length = 0;
+  unsigned long code, low;
+
+  if (!token->escaped)
+  {
+    memcpy(dest, text, token->length);
+    dest[token->length] = '\0';
+    return token->length;
+  }
+
+  while (text < end)
+  {
+    run = text;
+    if ((text = memchr(run, '\\', end - run)) == NULL)
+      text = end;
+    memcpy(&dest[length], run, text - run);
+    length += text - run;
+
+    if (text == end)
+      break;
+
+    switch (text[1])
+    {
+      case 'b': dest[length++] = '\b'; break;
+      case 'f': dest[length++] = '\f'; break;
+      case 'n': dest[length++] = '\n'; break;
+      case 'r': dest[length++] = '\r'; break;
+      case 't': dest[length++] = '\t'; break;
+      case 'u': break;
+      default:  dest[length++] = text[1]; break;//" \ and /
+    }
+
+    if (text[1] != 'u')
+    {
+      text += 2;
+      continue;
+    }
+
+    code = readHex4(&text[2]);
+    text += 6;
+
+    if (code >= 0xD800 && code <= 0xDBFF && end - text >= 6 && text[0] == '\\' && text[1] == 'u' &&
+        (low = readHex4(&text[2])) >= 0xDC00 && low <= 0xDFFF)//surrogate pair, 12 bytes in and 4 out
+    {
+      code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+      text += 6;
+    }
+    else if (code == 0 || (code >= 0xD800 && code <= 0xDFFF))
+    {
+      code = 0xFFFD;
+    }
+
+    length += appendUTF8(&dest[length], code);
+  }
+
+  dest[length] = '\0';
+
+  return length;
+}
+
+/**
+* jsonStringIs()
+*
+* true if the string token says literal
+**/
+bool jsonStringIs(const JSONToken *token, const char *literal)
+{
+  char *decoded;
+  bool same;
+
+  if (token->type != JSON_STRING)
+    return false;
+
+  if (!token->escaped)
+    return strlen(literal) == token->length && memcmp(token->start, literal, token->length) == 0;
+
+  if ((decoded = copyJSONString(token)) == NULL)
+    return false;
+
+  same = strcmp(decoded, literal) == 0;
+  free(decoded);
+
+  return same;
+}
+
+/**
+* copyJSONString()
+*
+* malloc'd copy of the string token with its escapes undone
+**/
+char *copyJSONString(const JSONToken *token)
+{
+  char *copy;
+
+  if ((copy = malloc(token->length + 1)) == NULL)
+    return NULL;
+
+  decodeJSONString(token, copy);
+
+  return copy;
+}
+
+/**
+* copyJSONName()
+*
+* a property, group or parameter name, interned like the vcf parser's names
+**/
+static char *copyJSONName(const JSONToken *token)
+{
+  char *decoded, *name;
+
+  if (!token->escaped)
+    return internOrCopy(NULL, token->start, token->length);
+
+  if ((decoded = copyJSONString(token)) == NULL)
+    return NULL;
+
+  name = internOrCopy(NULL, decoded, strlen(decoded));
+  free(decoded);
+
+  return name;
+}
+
+/**
+* copyJSONField()
+*
+* decode the string token in to a fixed size field, false if it doesn't fit
+**/
+static bool copyJSONField(const JSONToken *token, char *dest, size_t size)
+{
+  char *decoded;
+  bool fits;
+
+  if (token->length < size)//decoded is never longer
+  {
+    decodeJSONString(token, dest);
+    return true;
+  }
+
+  if (!token->escaped || (decoded = copyJSONString(token)) == NULL)
+    return false;
+
+  if ((fits = strlen(decoded) < size))
+    strcpy(dest, decoded);
+  free(decoded);
+
+  return fits;
+}
+
+/**
+* readJSONStrList()
+*
+* ["value",...] in to strList, first being the [
+**/
+bool readJSONStrList(JSONReader *reader, const JSONToken *first, List *strList)
+{
+  JSONToken value;
+  JSONItem item;
+  bool firstItem = true;
+  char *copy;
+
+  if (first->type != JSON_ARRAY)
+    return false;
+
+  while ((item = nextJSONElement(reader, &firstItem, &value)) == JSON_ITEM)
+  {
+    if (value.type != JSON_STRING || (copy = copyJSONString(&value)) == NULL)
+      return false;
+    insertBack(strList, copy);
+  }
+
+  return item == JSON_DONE;
+}
+
+/**
+* readJSONParameter()
+*
+* {"name":"","value":""}, first being the {
+**/
+static bool readJSONParameter(JSONReader *reader, const JSONToken *first, Parameter **newParam)
+{
+  JSONToken key, value, name = {JSON_BAD}, paramValue = {JSON_BAD};
+  JSONItem item;
+  bool ok = true, firstItem = true;
+
+  *newParam = NULL;
+
+  if (first->type != JSON_OBJECT)
+    return false;
+
+  while (ok && (item = nextJSONMember(reader, &firstItem, &key, &value)) == JSON_ITEM)
+  {
+    if (jsonStringIs(&key, "name"))
+    {
+      ok = value.type == JSON_STRING && name.type == JSON_BAD;
+      name = value;
+    }
+    else if (jsonStringIs(&key, "value"))
+    {
+      ok = value.type == JSON_STRING && paramValue.type == JSON_BAD;
+      paramValue = value;
+    }
+    else
+    {
+      ok = skipJSONValue(reader, &value);
+    }
+  }
+
+  if (!ok || item != JSON_DONE || name.type != JSON_STRING || name.length == 0 || paramValue.type != JSON_STRING)
+    return false;
+
+  if ((*newParam = malloc(sizeof(Parameter) + paramValue.length + 1)) == NULL)
+    return false;
+
+  decodeJSONString(&paramValue, (*newParam)->value);
+
+  if (((*newParam)->name = copyJSONName(&name)) == NULL)
+  {
+    free(*newParam);
+    *newParam = NULL;
+    return false;
+  }
+
+  return true;
+}
+
+/**
+* readJSONParameters()
+*
+* [{"name":"","value":""},...] in to parameters, first being the [
+**/
+static bool readJSONParameters(JSONReader *reader, const JSONToken *first, List *parameters)
+{
+  JSONToken value;
+  JSONItem item;
+  Parameter *param;
+  bool firstItem = true;
+
+  if (first->type != JSON_ARRAY)
+    return false;
+
+  while ((item = nextJSONElement(reader, &firstItem, &value)) == JSON_ITEM)
+  {
+    if (!readJSONParameter(reader, &value, &param))
+      return false;
+    insertBack(parameters, param);
+  }
+
+  return item == JSON_DONE;
+}
+
+/**
+* readJSONProperty()
+*
+* {"group":"","name":"","parameters":[],"values":[]}, first being the {. name and values are
+* needed, group and parameters may be left out
+**/
+bool readJSONProperty(JSONReader *reader, const JSONToken *first, Property **newProp)
+{
+  JSONToken key, value, group = {JSON_BAD}, name = {JSON_BAD};
+  JSONItem item = JSON_INVALID;
+  Property *prop;
+  bool ok, firstItem = true, haveValues = false, haveParameters = false;
+
+  *newProp = NULL;
+
+  if (first->type != JSON_OBJECT || (prop = malloc(sizeof(Property))) == NULL)
+    return false;
+
+  prop->name = NULL;
+  prop->group = NULL;
+  prop->parameters = initializeArrayList(printParameter, deleteParameter, compareParameters);
+  prop->values = initializeArrayList(printString, deleteString, compareString);
+  ok = prop->parameters != NULL && prop->values != NULL;
+
+  while (ok && (item = nextJSONMember(reader, &firstItem, &key, &value)) == JSON_ITEM)
+  {
+    if (jsonStringIs(&key, "group"))
+    {
+      ok = value.type == JSON_STRING && group.type == JSON_BAD;
+      group = value;
+    }
+    else if (jsonStringIs(&key, "name"))
+    {
+      ok = value.type == JSON_STRING && name.type == JSON_BAD;
+      name = value;
+    }
+    else if (jsonStringIs(&key, "values"))
+    {
+      ok = !haveValues && readJSONStrList(reader, &value, prop->values);
+      haveValues = true;
+    }
+    else if (jsonStringIs(&key, "parameters"))
+    {
+      ok = !haveParameters && readJSONParameters(reader, &value, prop->parameters);
+      haveParameters = true;
+    }
+    else
+    {
+      ok = skipJSONValue(reader, &value);
+    }
+  }
+
+  ok = ok && item == JSON_DONE && name.type == JSON_STRING && name.length > 0 && haveValues;
+  ok = ok && (prop->name = copyJSONName(&name)) != NULL;
+  ok = ok && (prop->group = group.type == JSON_STRING ? copyJSONName(&group) : internOrCopy(NULL, "", 0)) != NULL;
+
+  if (!ok)
+  {
+    deleteProperty(prop);
+    return false;
+  }
+
+  *newProp = prop;
+
+  return true;
+}
+
+/**
+* readJSONDateTime()
+*
+* {"isText":,"date":"","time":"","text":"","isUTC":}, first being the {. Only isText is
+* needed, whatever else is left out is empty or false
+**/
+bool readJSONDateTime(JSONReader *reader, const JSONToken *first, DateTime **newDate)
+{
+  JSONToken key, value, isText = {JSON_BAD}, isUTC = {JSON_BAD}, date = {JSON_BAD}, time = {JSON_BAD}, text = {JSON_BAD};
+  JSONToken *field;
+  JSONItem item = JSON_INVALID;
+  bool ok = true, firstItem = true;
+
+  *newDate = NULL;
+
+  if (first->type != JSON_OBJECT)
+    return false;
+
+  while (ok && (item = nextJSONMember(reader, &firstItem, &key, &value)) == JSON_ITEM)
+  {
+    field = NULL;
+
+    if (jsonStringIs(&key, "isText"))
+      field = &isText;
+    else if (jsonStringIs(&key, "isUTC"))
+      field = &isUTC;
+    else if (jsonStringIs(&key, "date"))
+      field = &date;
+    else if (jsonStringIs(&key, "time"))
+      field = &time;
+    else if (jsonStringIs(&key, "text"))
+      field = &text;
+
+    if (field == NULL)
+    {
+      ok = skipJSONValue(reader, &value);
+    }
+    else
+    {
+      ok = field->type == JSON_BAD;
+      *field = value;
+    }
+  }
+
+  if (!ok || item != JSON_DONE || (isText.type != JSON_TRUE && isText.type != JSON_FALSE) ||
+      (isUTC.type != JSON_BAD && isUTC.type != JSON_TRUE && isUTC.type != JSON_FALSE) ||
+      (date.type != JSON_BAD && date.type != JSON_STRING) || (time.type != JSON_BAD && time.type != JSON_STRING) ||
+      (text.type != JSON_BAD && text.type != JSON_STRING))
+    return false;
+
+  if ((*newDate = calloc(1, sizeof(DateTime) + (text.type == JSON_STRING ? text.length : 0) + 1)) == NULL)
+    return false;
+
+  (*newDate)->isText = isText.type == JSON_TRUE;
+  (*newDate)->UTC = isUTC.type == JSON_TRUE;
+
+  if (text.type == JSON_STRING)
+    decodeJSONString(&text, (*newDate)->text);
+
+  if ((date.type == JSON_STRING && !copyJSONField(&date, (*newDate)->date, sizeof((*newDate)->date))) ||
+      (time.type == JSON_STRING && !copyJSONField(&time, (*newDate)->time, sizeof((*newDate)->time))))//too long
+  {
+    free(*newDate);
+    *newDate = NULL;
+    return false;
+  }
+
+  return true;
+}
+
+/**
+* readJSONOptionalDate()
+*
+* a date member of a card, which may be null
+**/
+static bool readJSONOptionalDate(JSONReader *reader, const JSONToken *first, DateTime **date)
+{
+  if (*date != NULL)//key was already there
+    return false;
+
+  if (first->type == JSON_NULL)
+    return true;
+
+  return readJSONDateTime(reader, first, date);
+}
+
+/**
+* readJSONCard()
+*
+* {"fn":{},"optionalProperties":[],"birthday":{},"anniversary":{}} as written by cardToJSON,
+* first being the {. Only fn is needed
+**/
+bool readJSONCard(JSONReader *reader, const JSONToken *first, Card **newCard)
+{
+  JSONToken key, value, element;
+  JSONItem item = JSON_INVALID, elementItem = JSON_INVALID;
+  Property *prop;
+  Card *card;
+  bool ok = true, firstItem = true, firstElement, haveProperties = false;
+
+  *newCard = NULL;
+
+  if (first->type != JSON_OBJECT)
+    return false;
+
+  if ((card = initializeCard(printProperty, deleteProperty, compareProperties)) == NULL)
+    return false;
+
+  while (ok && (item = nextJSONMember(reader, &firstItem, &key, &value)) == JSON_ITEM)
+  {
+    if (jsonStringIs(&key, "fn"))
+    {
+      ok = card->fn == NULL && readJSONProperty(reader, &value, &card->fn);
+    }
+    else if (jsonStringIs(&key, "optionalProperties"))
+    {
+      ok = !haveProperties && value.type == JSON_ARRAY;
+      haveProperties = true;
+      firstElement = true;
+
+      while (ok && (elementItem = nextJSONElement(reader, &firstElement, &element)) == JSON_ITEM)
+      {
+        if ((ok = readJSONProperty(reader, &element, &prop)))
+          appendProperty(card, prop);
+      }
+
+      ok = ok && elementItem == JSON_DONE;
+    }
+    else if (jsonStringIs(&key, "birthday"))
+    {
+      ok = readJSONOptionalDate(reader, &value, &card->birthday);
+    }
+    else if (jsonStringIs(&key, "anniversary"))
+    {
+      ok = readJSONOptionalDate(reader, &value, &card->anniversary);
+    }
+    else
+    {
+      ok = skipJSONValue(reader, &value);
+    }
+  }
+
+  if (!ok || item != JSON_DONE || card->fn == NULL)
+  {
+    deleteCard(card);
+    return false;
+  }
+
+  *newCard = card;
+
+  return true;
+}
+
+/**
+* readJSONFN()
+*
+* {"FN":"value"}, the short form JSONtoCard has always taken: the first member is the fn
+* property, anything after it is skipped. first being the {
+**/
+bool readJSONFN(JSONReader *reader, const JSONToken *first, Card **newCard)
+{
+  JSONToken fnName, fnToken, key, value;
+  JSONItem item;
+  Property *fn;
+  Card *card;
+  char *fnValue;
+  bool firstItem = true;
+
+  *newCard = NULL;
+
+  if (first->type != JSON_OBJECT || nextJSONMember(reader, &firstItem, &fnName, &fnToken) != JSON_ITEM ||
+      fnToken.type != JSON_STRING || fnName.length == 0)
+    return false;
+
+  while ((item = nextJSONMember(reader, &firstItem, &key, &value)) == JSON_ITEM)
+  {
+    if (!skipJSONValue(reader, &value))
+      return false;
+  }
+
+  if (item != JSON_DONE)
+    return false;
+
+  if ((card = initializeCard(printProperty, deleteProperty, compareProperties)) == NULL)
+    return false;
+
+  if ((fn = malloc(sizeof(Property))) == NULL)
+  {
+    deleteCard(card);
+    return false;
+  }
+
+  card->fn = fn;
+  fn->group = internOrCopy(NULL, "", 0);
+  fn->name = copyJSONName(&fnName);
+  fn->parameters = initializeArrayList(printParameter, deleteParameter, compareParameters);
+  fn->values = initializeArrayList(printString, deleteString, compareString);
+
+  if (fn->group == NULL || fn->name == NULL || fn->parameters == NULL || fn->values == NULL ||
+      (fnValue = copyJSONString(&fnToken)) == NULL)
+  {
+    deleteCard(card);
+    return false;
+  }
+
+  insertBack(fn->values, fnValue);
+  *newCard = card;
+
+  return true;
+}
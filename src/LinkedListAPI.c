@@ -8,6 +8,402 @@
 #include "LinkedListAPI.h"
 #include "assert.h"
 
+//nodes in the first slab of a list, each slab after that is twice the size up to the max.
+//Most lists hold a handful of values, so the first slab is usually the only malloc
+#define FIRST_SLAB_NODES 4
+#define MAX_SLAB_NODES 256
+
+//slots in the first array of an array list, it doubles every time it fills
+#define FIRST_ARRAY_SLOTS 4
+
+//runs this short are insertion sorted instead of split further
+#define SHORT_RUN 8
+
+/**
+ * Block of nodes handed out one at a time by slabNode
+ **/
+typedef struct nodeSlab{
+	struct nodeSlab* next;
+	int size;
+	int used;
+	Node nodes[];
+} NodeSlab;
+
+/**Takes a node from the list's free nodes, or its newest slab, starting a bigger slab
+* when that one is used up
+* @return the node, NULL if allocation failed
+**/
+static Node* slabNode(List* list){
+	NodeSlab* slab = list->slabs;
+	Node* tmpNode;
+	int size;
+
+	if (list->freeNodes != NULL){
+		tmpNode = list->freeNodes;
+		list->freeNodes = tmpNode->next;
+		return tmpNode;
+	}
+
+	if (slab == NULL || slab->used == slab->size){
+		size = slab == NULL ? FIRST_SLAB_NODES : (slab->size < MAX_SLAB_NODES ? slab->size * 2 : MAX_SLAB_NODES);
+
+		if ((slab = malloc(sizeof(NodeSlab) + size * sizeof(Node))) == NULL){
+			return NULL;
+		}
+
+		slab->size = size;
+		slab->used = 0;
+		slab->next = list->slabs;
+		list->slabs = slab;
+	}
+
+	return &(slab->nodes[slab->used++]);
+}
+
+/**Frees every slab of list at once, the nodes in them must not be used after this
+**/
+static void releaseSlabs(List* list){
+	NodeSlab* slab;
+
+	while (list->slabs != NULL){
+		slab = list->slabs;
+		list->slabs = slab->next;
+		free(slab);
+	}
+
+	list->freeNodes = NULL;
+}
+
+/**Creates a node for list, from the list's pool if it has one and from its slabs if not.
+* Counts as a change to list
+* @return the new node, NULL if allocation failed
+**/
+static Node* listNode(List* list, void* data){
+	Node* tmpNode;
+
+	if (list->allocate == NULL){
+		tmpNode = slabNode(list);
+	}
+	else{
+		tmpNode = list->allocate(list->pool, sizeof(Node));
+	}
+
+	if (tmpNode != NULL){
+		tmpNode->data = data;
+		tmpNode->previous = NULL;
+		tmpNode->next = NULL;
+		list->changes++;
+	}
+
+	return tmpNode;
+}
+
+/**Gives back a node that was made by listNode. Slab nodes are kept for reuse, pool nodes
+* are left to the pool
+**/
+static void releaseNode(List* list, Node* node){
+	list->changes++;
+
+	if (list->allocate == NULL){
+		node->next = list->freeNodes;
+		list->freeNodes = node;
+	}
+}
+
+/**Makes sure an array list has extra free slots at the end, doubling its array until they fit.
+* A pool array is copied in to a new one and the old one left to the pool
+* @return false if allocation failed
+**/
+static bool growArray(List* list, int extra){
+	void** tmpArray;
+	int size;
+
+	if (list->length + extra <= list->capacity){
+		return true;
+	}
+
+	size = list->capacity == 0 ? FIRST_ARRAY_SLOTS : list->capacity * 2;
+	while (size < list->length + extra){
+		size *= 2;
+	}
+
+	if (list->allocate == NULL){
+		tmpArray = realloc(list->elements, size * sizeof(void*));
+	}
+	else if ((tmpArray = list->allocate(list->pool, size * sizeof(void*))) != NULL && list->length > 0){
+		memcpy(tmpArray, list->elements, list->length * sizeof(void*));
+	}
+
+	if (tmpArray == NULL){
+		return false;
+	}
+
+	list->elements = tmpArray;
+	list->capacity = size;
+
+	return true;
+}
+
+/**Puts data in slot index of an array list, everything from index on moves up one.
+* Counts as a change to list
+**/
+static void insertSlot(List* list, int index, void* data){
+	if (!growArray(list, 1)){
+		return;
+	}
+
+	memmove(&(list->elements[index + 1]), &(list->elements[index]), (list->length - index) * sizeof(void*));
+	list->elements[index] = data;
+
+	(list->length)++;
+	list->changes++;
+}
+
+/**Takes slot index out of an array list, everything after it moves down one.
+* Counts as a change to list
+* @return the data that was in the slot
+**/
+static void* removeSlot(List* list, int index){
+	void* data = list->elements[index];
+
+	memmove(&(list->elements[index]), &(list->elements[index + 1]), (list->length - index - 1) * sizeof(void*));
+
+	(list->length)--;
+	list->changes++;
+
+	return data;
+}
+
+/**Sets up a new list head, shared by the initialize functions
+**/
+static void startList(List* tmpList, void* (*allocate)(void* pool, size_t size), void* pool, bool contiguous, char* (*printFunction)(void* toBePrinted),void (*deleteFunction)(void* toBeDeleted),int (*compareFunction)(const void* first,const void* second)){
+	tmpList->head = NULL;
+	tmpList->tail = NULL;
+
+	tmpList->length = 0;
+	tmpList->changes = 0;
+
+	tmpList->deleteData = deleteFunction;
+	tmpList->compare = compareFunction;
+	tmpList->printData = printFunction;
+
+	tmpList->allocate = allocate;
+	tmpList->pool = pool;
+
+	tmpList->slabs = NULL;
+	tmpList->freeNodes = NULL;
+
+	tmpList->contiguous = contiguous;
+	tmpList->elements = NULL;
+	tmpList->capacity = 0;
+
+	tmpList->owner = NULL;
+}
+
+/**Merges two sorted chains of nodes linked by next, only next is kept up to date.
+* On a tie the node from first goes first, so merging is stable
+* @return the head of the merged chain
+**/
+static Node* mergeNodes(List* list, Node* first, Node* second){
+	Node merged;
+	Node* last = &merged;
+
+	while (first != NULL && second != NULL){
+		if (list->compare(second->data, first->data) < 0){
+			last->next = second;
+			second = second->next;
+		}
+		else{
+			last->next = first;
+			first = first->next;
+		}
+		last = last->next;
+	}
+
+	last->next = first != NULL ? first : second;
+
+	return merged.next;
+}
+
+/**Merge sorts the length nodes starting at *rest, length must be at least 1. The halves are
+* taken off the front as they are sorted, so the chain is never walked just to split it
+* @return the head of the sorted chain, *rest is left on the node after the last one taken
+**/
+static Node* sortNodes(List* list, Node** rest, int length){
+	Node* first;
+	Node* second;
+
+	if (length == 1){
+		first = *rest;
+		*rest = first->next;
+		first->next = NULL;
+		return first;
+	}
+
+	first = sortNodes(list, rest, length / 2);
+	second = sortNodes(list, rest, length - length / 2);
+
+	return mergeNodes(list, first, second);
+}
+
+/**Makes list the chain starting at head, filling in previous and tail from the next links
+**/
+static void linkNodes(List* list, Node* head){
+	Node* previous = NULL;
+
+	list->head = head;
+
+	for (; head != NULL; head = head->next){
+		head->previous = previous;
+		previous = head;
+	}
+
+	list->tail = previous;
+}
+
+/**Stable insertion sort of length slots, for short runs and for when there is no scratch space
+**/
+static void insertionSortSlots(List* list, void** slots, int length){
+	void* data;
+	int i, j;
+
+	for (i = 1; i < length; i++){
+		data = slots[i];
+
+		for (j = i; j > 0 && list->compare(data, slots[j - 1]) < 0; j--){
+			slots[j] = slots[j - 1];
+		}
+
+		slots[j] = data;
+	}
+}
+
+/**Merges the sorted slots [0, middle) and [middle, length) through scratch. On a tie the
+* slot from the first run goes first, so merging is stable
+**/
+static void mergeSlots(List* list, void** slots, int middle, int length, void** scratch){
+	int i = 0, j = middle, k = 0;
+
+	while (i < middle && j < length){
+		scratch[k++] = list->compare(slots[j], slots[i]) < 0 ? slots[j++] : slots[i++];
+	}
+
+	while (i < middle){
+		scratch[k++] = slots[i++];
+	}
+
+	//whatever is left of the second run is already in place
+	memcpy(slots, scratch, k * sizeof(void*));
+}
+
+/**Stable merge sort of length slots, scratch must have room for length of them
+**/
+static void sortSlots(List* list, void** slots, int length, void** scratch){
+	if (length <= SHORT_RUN){
+		insertionSortSlots(list, slots, length);
+		return;
+	}
+
+	sortSlots(list, slots, length / 2, scratch);
+	sortSlots(list, &(slots[length / 2]), length - length / 2, scratch);
+
+	mergeSlots(list, slots, length / 2, length, scratch);
+}
+
+/**Takes node out of list and gives it back, counts as a change to list
+* @return the node's data
+**/
+static void* unlinkNode(List* list, Node* delNode){
+	void* data = delNode->data;
+
+	if (delNode->previous != NULL){
+		delNode->previous->next = delNode->next;
+	}else{
+		list->head = delNode->next;
+	}
+
+	if (delNode->next != NULL){
+		delNode->next->previous = delNode->previous;
+	}else{
+		list->tail = delNode->previous;
+	}
+
+	releaseNode(list, delNode);
+	(list->length)--;
+
+	return data;
+}
+
+/**Links the chain first..last, already joined by next and previous, in to list after the node
+* previous, or at the front if previous is NULL. Only the links are touched
+**/
+static void linkAfter(List* list, Node* previous, Node* first, Node* last){
+	Node* next = previous != NULL ? previous->next : list->head;
+
+	first->previous = previous;
+	last->next = next;
+
+	if (previous != NULL){
+		previous->next = first;
+	}
+	else{
+		list->head = first;
+	}
+
+	if (next != NULL){
+		next->previous = last;
+	}
+	else{
+		list->tail = last;
+	}
+}
+
+/**The node an iterator over a linked list sits after, the last one nextElement went past.
+* NULL if it is still in front of the head
+**/
+static Node* nodeBefore(List* list, ListIterator* iter){
+	return iter->current != NULL ? iter->current->previous : list->tail;
+}
+
+/**Leaves list empty without deleting its data, which has been moved to another list.
+* Counts as a change to list
+**/
+static void dropElements(List* list){
+	if (list->contiguous && list->allocate == NULL){
+		free(list->elements);
+	}
+
+	releaseSlabs(list);
+
+	list->elements = NULL;
+	list->capacity = 0;
+	list->head = NULL;
+	list->tail = NULL;
+	list->length = 0;
+	list->changes++;
+}
+
+/**Hands every slab of source over to dest, so nodes moved from source to dest stay alive as
+* long as dest does. source's free nodes are left in the slabs unused
+**/
+static void adoptSlabs(List* dest, List* source){
+	NodeSlab* last = source->slabs;
+
+	if (last == NULL){
+		return;
+	}
+
+	while (last->next != NULL){
+		last = last->next;
+	}
+
+	last->next = dest->slabs;
+	dest->slabs = source->slabs;
+
+	source->slabs = NULL;
+	source->freeNodes = NULL;
+}
+
 /** Function for creating an iterator for the linked list.
  * This node contains abstracted (void *) data as well as previous and next
  * pointers to connect to other nodes in the list
@@ -20,10 +416,15 @@ ListIterator createIterator(List* list)
 {
   ListIterator newListIter;
 
-  if (list == NULL) {
-    newListIter.current = NULL;
+  newListIter.current = NULL;
+  newListIter.list = NULL;
+  newListIter.index = 0;
+  newListIter.removable = false;
+
+  if (list != NULL && list->contiguous) {
+    newListIter.list = list;
   }
-  else{
+  else if (list != NULL){
     newListIter.current = list->head;
   }
 
@@ -43,6 +444,13 @@ void* nextElement(ListIterator* iter)
 {
   Node *temp = iter->current;
 
+  if (iter->list != NULL) {
+    iter->removable = iter->index < iter->list->length;
+    return iter->removable ? iter->list->elements[iter->index++] : NULL;
+  }
+
+  iter->removable = temp != NULL;
+
   if (iter->current!=NULL) {
     iter->current = iter->current->next;
   }
@@ -63,10 +471,25 @@ void* nextElement(ListIterator* iter)
 void clearList(List* list)
 {
   Node *temp;
+  int i;
 
   if (list==NULL) {
     return;
   }
+  else if (list->contiguous){
+    for (i = 0; i < list->length; i++)
+    {
+      list->deleteData(list->elements[i]);
+      list->changes++;
+    }
+
+    if (list->allocate == NULL)
+      free(list->elements);
+
+    list->elements = NULL;
+    list->capacity = 0;
+    list->length = 0;
+  }
   else{
     while (list->head != NULL)/*loop while nodes are still in list*/
     {
@@ -74,11 +497,11 @@ void clearList(List* list)
       list->head = list->head->next;
 
       list->deleteData(temp->data);
-      temp->previous = NULL;
-      temp->next = NULL;
-      free(temp);
+      list->changes++;
     }
 
+    releaseSlabs(list);//every node goes back in one go
+
     list->head = NULL;
     list->tail = NULL;
     list->length = 0;
@@ -102,15 +525,76 @@ List * initializeList(char* (*printFunction)(void* toBePrinted),void (*deleteFun
     if (tmpList == NULL)
       return NULL;
 
+	startList(tmpList, NULL, NULL, false, printFunction, deleteFunction, compareFunction);
 
-	tmpList->head = NULL;
-	tmpList->tail = NULL;
+	return tmpList;
+}
 
-	tmpList->length = 0;
+/** Function to initialize a list whose head and nodes are allocated from a pool instead of malloc.
+*@return pointer to the list head, NULL if allocate fails
+*@param allocate function returning size bytes from pool
+*@param pool passed to allocate unchanged
+*@param printFunction function pointer to print a single node of the list
+*@param deleteFunction function pointer to delete a single piece of data from the list
+*@param compareFunction function pointer to compare two nodes of the list in order to test for equality or order
+**/
+List * initializeListFrom(void* (*allocate)(void* pool, size_t size), void* pool, char* (*printFunction)(void* toBePrinted),void (*deleteFunction)(void* toBeDeleted),int (*compareFunction)(const void* first,const void* second)){
+    assert(allocate != NULL);
+    assert(printFunction != NULL);
+    assert(deleteFunction != NULL);
+    assert(compareFunction != NULL);
 
-	tmpList->deleteData = deleteFunction;
-	tmpList->compare = compareFunction;
-	tmpList->printData = printFunction;
+    List * tmpList = allocate(pool, sizeof(List));
+
+    if (tmpList == NULL)
+      return NULL;
+
+	startList(tmpList, allocate, pool, false, printFunction, deleteFunction, compareFunction);
+
+	return tmpList;
+}
+
+/** Function to initialize a list that keeps its data in one contiguous array instead of in nodes.
+*@return pointer to the list head, NULL if malloc fails
+*@param printFunction function pointer to print a single node of the list
+*@param deleteFunction function pointer to delete a single piece of data from the list
+*@param compareFunction function pointer to compare two nodes of the list in order to test for equality or order
+**/
+List * initializeArrayList(char* (*printFunction)(void* toBePrinted),void (*deleteFunction)(void* toBeDeleted),int (*compareFunction)(const void* first,const void* second)){
+    assert(printFunction != NULL);
+    assert(deleteFunction != NULL);
+    assert(compareFunction != NULL);
+
+    List * tmpList = malloc(sizeof(List));
+
+    if (tmpList == NULL)
+      return NULL;
+
+	startList(tmpList, NULL, NULL, true, printFunction, deleteFunction, compareFunction);
+
+	return tmpList;
+}
+
+/** Function to initialize an array list whose head and array are allocated from a pool instead of malloc.
+*@return pointer to the list head, NULL if allocate fails
+*@param allocate function returning size bytes from pool
+*@param pool passed to allocate unchanged
+*@param printFunction function pointer to print a single node of the list
+*@param deleteFunction function pointer to delete a single piece of data from the list
+*@param compareFunction function pointer to compare two nodes of the list in order to test for equality or order
+**/
+List * initializeArrayListFrom(void* (*allocate)(void* pool, size_t size), void* pool, char* (*printFunction)(void* toBePrinted),void (*deleteFunction)(void* toBeDeleted),int (*compareFunction)(const void* first,const void* second)){
+    assert(allocate != NULL);
+    assert(printFunction != NULL);
+    assert(deleteFunction != NULL);
+    assert(compareFunction != NULL);
+
+    List * tmpList = allocate(pool, sizeof(List));
+
+    if (tmpList == NULL)
+      return NULL;
+
+	startList(tmpList, allocate, pool, true, printFunction, deleteFunction, compareFunction);
 
 	return tmpList;
 }
@@ -125,7 +609,8 @@ List * initializeList(char* (*printFunction)(void* toBePrinted),void (*deleteFun
 void freeList(List* list){
 
     clearList(list);
-	free(list);
+    if (list != NULL && list->allocate == NULL)//pool lists go with their pool
+	    free(list);
 }
 
 /**Function for creating a node for the linked list.
@@ -162,10 +647,18 @@ void insertBack(List* list, void* toBeAdded){
 		return;
 	}
 
-	(list->length)++;
+	if (list->contiguous){
+		insertSlot(list, list->length, toBeAdded);
+		return;
+	}
 
-	Node* newNode = initializeNode(toBeAdded);
+	Node* newNode = listNode(list, toBeAdded);
 
+	if (newNode == NULL){
+		return;
+	}
+
+	(list->length)++;
 
     if (list->head == NULL && list->tail == NULL){
         list->head = newNode;
@@ -188,10 +681,18 @@ void insertFront(List* list, void* toBeAdded){
 		return;
 	}
 
-	(list->length)++;
+	if (list->contiguous){
+		insertSlot(list, 0, toBeAdded);
+		return;
+	}
 
-	Node* newNode = initializeNode(toBeAdded);
+	Node* newNode = listNode(list, toBeAdded);
 
+	if (newNode == NULL){
+		return;
+	}
+
+	(list->length)++;
     if (list->head == NULL && list->tail == NULL){
         list->head = newNode;
         list->tail = list->head;
@@ -208,6 +709,10 @@ void insertFront(List* list, void* toBeAdded){
  *@return pointer to the data located at the head of the list
  **/
 void* getFromFront(List * list){
+	if (list->contiguous){
+		return list->length > 0 ? list->elements[0] : NULL;
+	}
+
 	if (list->head == NULL){
 		return NULL;
 	}
@@ -221,6 +726,10 @@ void* getFromFront(List * list){
  *@return pointer to the data located at the tail of the list
  **/
 void* getFromBack(List * list){
+	if (list->contiguous){
+		return list->length > 0 ? list->elements[list->length - 1] : NULL;
+	}
+
 	if (list->tail == NULL){
 		return NULL;
 	}
@@ -244,32 +753,21 @@ void* deleteDataFromList(List* list, void* toBeDeleted){
 		return NULL;
 	}
 
-	Node* tmp = list->head;
-
-	while(tmp != NULL){
-		if (list->compare(toBeDeleted, tmp->data) == 0){
-			//Unlink the node
-			Node* delNode = tmp;
-
-			if (tmp->previous != NULL){
-				tmp->previous->next = delNode->next;
-			}else{
-				list->head = delNode->next;
-			}
-
-			if (tmp->next != NULL){
-				tmp->next->previous = delNode->previous;
-			}else{
-				list->tail = delNode->previous;
+	if (list->contiguous){
+		for (int i = 0; i < list->length; i++){
+			if (list->compare(toBeDeleted, list->elements[i]) == 0){
+				return removeSlot(list, i);
 			}
+		}
 
-			void* data = delNode->data;
-			free(delNode);
-
-			(list->length)--;
+		return NULL;
+	}
 
-			return data;
+	Node* tmp = list->head;
 
+	while(tmp != NULL){
+		if (list->compare(toBeDeleted, tmp->data) == 0){
+			return unlinkNode(list, tmp);
 		}else{
 			tmp = tmp->next;
 		}
@@ -293,7 +791,16 @@ void insertSorted(List *list, void *toBeAdded){
 		return;
 	}
 
-	(list->length)++;
+	if (list->contiguous){
+		int i = 0;
+
+		while (i < list->length && list->compare(toBeAdded, list->elements[i]) > 0){
+			i++;
+		}
+
+		insertSlot(list, i, toBeAdded);
+		return;
+	}
 
 	if (list->head == NULL){
 		insertBack(list, toBeAdded);
@@ -314,14 +821,13 @@ void insertSorted(List *list, void *toBeAdded){
 
 	while (currNode != NULL){
 		if (list->compare(toBeAdded, currNode->data) <= 0){
+			Node* newNode = listNode(list, toBeAdded);
 
-			char* currDescr = list->printData(currNode->data);
-			char* newDescr = list->printData(toBeAdded);
-
-			free(currDescr);
-			free(newDescr);
+			if (newNode == NULL){
+				return;
+			}
 
-			Node* newNode = initializeNode(toBeAdded);
+			(list->length)++;
 			newNode->next = currNode;
 			newNode->previous = currNode->previous;
 			currNode->previous->next = newNode;
@@ -336,36 +842,389 @@ void insertSorted(List *list, void *toBeAdded){
 	return;
 }
 
-/**Returns a string that contains a string representation of the list traversed from  head to tail.
-Utilizes an iterator and the list's printData function pointer to create the string.
-returned string must be freed by the calling function.
+/** Sorts the list in place with the list's compare function, in O(n log n) compares.
+* The sort is stable, elements that compare equal keep their order.
+*@pre List exists and has memory allocated to it
+*@post The list is in order, no data or nodes are allocated or freed
+*@param list a pointer to the dummy head of the list
+**/
+void sortList(List* list){
+	void** scratch;
+	Node* rest;
+
+	if (list == NULL || list->length < 2){
+		return;
+	}
+
+	if (list->contiguous){
+		scratch = list->length > SHORT_RUN ? malloc(list->length * sizeof(void*)) : NULL;
+
+		if (scratch == NULL){//short, or out of memory: sorted where it is
+			insertionSortSlots(list, list->elements, list->length);
+		}
+		else{
+			sortSlots(list, list->elements, list->length, scratch);
+			free(scratch);
+		}
+	}
+	else{
+		rest = list->head;
+		linkNodes(list, sortNodes(list, &rest, list->length));
+	}
+
+	list->changes++;
+}
+
+/** Adds count elements to a sorted list at once. The new elements are sorted among themselves
+* and merged in with one pass over the list, instead of one pass per element.
+* As with insertSorted a new element goes in front of equal ones already in the list
+*@pre List exists, has memory allocated to it and is sorted
+*@post The list is sorted and holds every non NULL element of toBeAdded
+*@param list a pointer to the dummy head of the list
+*@param toBeAdded an array of count pointers to data to add, NULL entries are skipped
+*@param count the number of entries in toBeAdded
+**/
+void insertSortedBatch(List* list, void** toBeAdded, int count){
+	Node* added = NULL;
+	Node* last = NULL;
+	Node* newNode;
+	void** scratch;
+	int i, kept = 0;
+
+	if (list == NULL || toBeAdded == NULL || count <= 0){
+		return;
+	}
+
+	if (list->contiguous){
+		for (i = 0; i < count; i++){
+			kept += toBeAdded[i] != NULL;
+		}
+
+		if (kept == 0 || !growArray(list, kept)){
+			return;
+		}
+
+		//the new data goes in front, so a stable merge puts it first among equals
+		memmove(&(list->elements[kept]), list->elements, list->length * sizeof(void*));
+		for (i = 0, kept = 0; i < count; i++){
+			if (toBeAdded[i] != NULL){
+				list->elements[kept++] = toBeAdded[i];
+			}
+		}
+
+		if ((scratch = malloc((list->length + kept) * sizeof(void*))) == NULL){
+			insertionSortSlots(list, list->elements, list->length + kept);
+		}
+		else{
+			sortSlots(list, list->elements, kept, scratch);
+			mergeSlots(list, list->elements, kept, list->length + kept, scratch);
+			free(scratch);
+		}
+
+		list->length += kept;
+		list->changes += kept;
+		return;
+	}
+
+	for (i = 0; i < count; i++){
+		if (toBeAdded[i] == NULL){
+			continue;
+		}
+
+		if ((newNode = listNode(list, toBeAdded[i])) == NULL){
+			break;
+		}
+
+		if (last == NULL){
+			added = newNode;
+		}
+		else{
+			last->next = newNode;
+		}
+
+		last = newNode;
+		kept++;
+	}
+
+	if (kept == 0){
+		return;
+	}
+
+	newNode = added;
+	added = sortNodes(list, &newNode, kept);
+	linkNodes(list, mergeNodes(list, added, list->head));
+
+	list->length += kept;
+}
+
+/** Removes the element nextElement last returned through iter, without searching for it.
+* iter carries on with the element that came after the removed one
+*@pre List exists, iter was created on it and nothing but iter has changed the list since
+*@post The element is no longer in the list. Its data is not freed
+*@param list a pointer to the dummy head of the list
+*@param iter the iterator that returned the element
+*@return the removed data, NULL if iter has not returned anything since it was created or last edited the list
+**/
+void* removeAt(List* list, ListIterator* iter){
+	if (list == NULL || iter == NULL || !iter->removable){
+		return NULL;
+	}
+
+	iter->removable = false;
+
+	if (list->contiguous){
+		return removeSlot(list, --(iter->index));
+	}
+
+	return unlinkNode(list, nodeBefore(list, iter));
+}
+
+/** Adds data right after the element nextElement last returned through iter, or at the front of the
+* list if it has not returned one yet. iter steps over the new element, so it carries on with the
+* element it would have returned anyway
+*@pre List exists, iter was created on it and nothing but iter has changed the list since
+*@post The data is in the list after the iterator's last element
+*@param list a pointer to the dummy head of the list
+*@param iter the iterator marking the place to insert
+*@param toBeAdded a pointer to data that is to be added to the list
+**/
+void insertAfter(List* list, ListIterator* iter, void* toBeAdded){
+	Node* newNode;
+	int length;
+
+	if (list == NULL || iter == NULL || toBeAdded == NULL){
+		return;
+	}
+
+	iter->removable = false;
+
+	if (list->contiguous){
+		length = list->length;
+		insertSlot(list, iter->index, toBeAdded);
+		iter->index += list->length - length;
+		return;
+	}
+
+	if ((newNode = listNode(list, toBeAdded)) == NULL){
+		return;
+	}
+
+	linkAfter(list, nodeBefore(list, iter), newNode, newNode);
+	(list->length)++;
+}
+
+/** Moves every element of source in to dest where at is, see insertAfter, or at the back of dest if
+* at is NULL. Between two linked lists that get their nodes from the same place the nodes themselves
+* are moved, along with source's slabs, so no element is copied or visited. Anything else is moved
+* element by element
+*@pre Both lists exist. at, if given, was created on dest
+*@post source is empty, its data is in dest in the same order and has not been freed
+*@param dest the list to move the elements to
+*@param at where in dest to put them, NULL for the back
+*@param source the list to move the elements from
+**/
+void spliceList(List* dest, ListIterator* at, List* source){
+	ListIterator iter;
+	Node* first = NULL;
+	Node* last = NULL;
+	Node* newNode;
+	void* data;
+	int i, moved;
+
+	if (dest == NULL || source == NULL || dest == source || source->length == 0){
+		return;
+	}
+
+	moved = source->length;
+
+	if (dest->contiguous){
+		i = at != NULL ? at->index : dest->length;
+
+		if (!growArray(dest, moved)){
+			return;
+		}
+
+		memmove(&(dest->elements[i + moved]), &(dest->elements[i]), (dest->length - i) * sizeof(void*));
+
+		iter = createIterator(source);
+		while ((data = nextElement(&iter)) != NULL){
+			dest->elements[i++] = data;
+		}
+
+		if (at != NULL){
+			at->index += moved;
+		}
+	}
+	else if (!source->contiguous && source->allocate == dest->allocate && source->pool == dest->pool){
+		first = source->head;
+		last = source->tail;
+		adoptSlabs(dest, source);
+	}
+	else{
+		iter = createIterator(source);
+		while ((data = nextElement(&iter)) != NULL){
+			if ((newNode = listNode(dest, data)) == NULL){//undo, so both lists are as they were
+				for (; first != NULL; first = newNode){
+					newNode = first->next;
+					releaseNode(dest, first);
+				}
+				return;
+			}
+
+			if (last == NULL){
+				first = newNode;
+			}
+			else{
+				last->next = newNode;
+				newNode->previous = last;
+			}
+
+			last = newNode;
+		}
+	}
+
+	if (!dest->contiguous){
+		linkAfter(dest, at != NULL ? nodeBefore(dest, at) : dest->tail, first, last);
+	}
+
+	if (at != NULL){
+		at->removable = false;
+	}
+
+	dest->length += moved;
+	dest->changes++;
+
+	dropElements(source);
+}
+
+/** Moves every element of source to the back of dest, see spliceList
+*@pre Both lists exist
+*@post source is empty, its data is at the back of dest in the same order and has not been freed
+*@param dest the list to move the elements to
+*@param source the list to move the elements from
+**/
+void concatList(List* dest, List* source){
+	spliceList(dest, NULL, source);
+}
+
+/**Growable string the list text is built up in, so each piece is copied once
+**/
+typedef struct stringBuilder{
+	char* data;
+	size_t length;
+	size_t size;
+} StringBuilder;
+
+/**Stream writer that adds text to a StringBuilder, doubling it as needed so building
+* stays linear in the length of the string
+**/
+static bool appendToBuilder(void* builder, const char* text, size_t length){
+	StringBuilder* str = (StringBuilder*)builder;
+	size_t newSize = str->size;
+	char* temp;
+
+	while (newSize - str->length <= length){//always room for the NUL after it
+		newSize *= 2;
+	}
+
+	if (newSize != str->size){
+		if ((temp = realloc(str->data, newSize)) == NULL){
+			return false;
+		}
+		str->data = temp;
+		str->size = newSize;
+	}
+
+	memcpy(&(str->data[str->length]), text, length);
+	str->length += length;
+	str->data[str->length] = '\0';
+
+	return true;
+}
+
+/**Stream writer that hands text straight to a FILE*
+**/
+static bool writeToFile(void* fp, const char* text, size_t length){
+	return fwrite(text, 1, length, (FILE*)fp) == length;
+}
+
+/** Passes the text of every element, each followed by separator, to write in order from head to tail.
+* Each element is printed with the list's printData function and freed as soon as it is written,
+* so the text of the whole list is never held at once
+*@pre List must exist, but does not have to have elements.
+*@param list Pointer to linked list dummy head.
+*@param separator text written after each element
+*@param write called with each piece of text, returns false to stop
+*@param context passed to write unchanged
+*@return true if every element was written, false if printData or write failed
+ **/
+bool streamList(List* list, const char* separator, bool (*write)(void* context, const char* text, size_t length), void* context){
+	ListIterator iter = createIterator(list);
+	size_t separatorLength = strlen(separator);
+	char* currDescr;
+	void* elem;
+	bool ok = true;
+
+	while (ok && (elem = nextElement(&iter)) != NULL){
+		if ((currDescr = list->printData(elem)) == NULL){
+			return false;
+		}
+
+		ok = write(context, currDescr, strlen(currDescr)) && write(context, separator, separatorLength);
+
+		free(currDescr);
+	}
+
+	return ok;
+}
+
+/** Writes the text of every element, each followed by separator, to fp, see streamList.
+*@param list Pointer to linked list dummy head.
+*@param separator text written after each element
+*@param fp file to write to
+*@return true on success, false if an element could not be printed or written
+ **/
+bool writeList(List* list, const char* separator, FILE* fp){
+	return streamList(list, separator, writeToFile, fp);
+}
+
+/**Returns the text of every element, each followed by separator, as one string.
+* The string is built in one growable buffer, so this is linear in its length.
+* returned string must be freed by the calling function.
  *@pre List must exist, but does not have to have elements.
  *@param list Pointer to linked list dummy head.
+ *@param separator text put after each element
  *@return on success: char * to string representation of list (must be freed after use).  on failure: NULL
  **/
-char* toString(List * list){
-	ListIterator iter = createIterator(list);
-	char* str;
+char* joinList(List* list, const char* separator){
+	StringBuilder str;
 
-	str = (char*)malloc(sizeof(char));
+	str.length = 0;
+	str.size = 64;
 
-  if(str == NULL)
-    return NULL;
-
-	strcpy(str, "");
+	if ((str.data = malloc(str.size)) == NULL){
+		return NULL;
+	}
 
-	void* elem;
-	while((elem = nextElement(&iter)) != NULL){
-		char* currDescr = list->printData(elem);
-    int newLen = strlen(str)+50+strlen(currDescr);
-		str = (char*)realloc( str, newLen);
-		strcat(str, currDescr);
-    strcat(str, "\n");
+	str.data[0] = '\0';
 
-		free(currDescr);
+	if (!streamList(list, separator, appendToBuilder, &str)){
+		free(str.data);
+		return NULL;
 	}
 
-	return str;
+	return str.data;
+}
+
+/**Returns a string that contains a string representation of the list traversed from  head to tail.
+Utilizes the list's printData function pointer to create the string, one element per line.
+returned string must be freed by the calling function.
+ *@pre List must exist, but does not have to have elements.
+ *@param list Pointer to linked list dummy head.
+ *@return on success: char * to string representation of list (must be freed after use).  on failure: NULL
+ **/
+char* toString(List * list){
+	return joinList(list, "\n");
 }
 
 
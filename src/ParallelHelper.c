@@ -0,0 +1,247 @@
+/**
+ * @file ParallelHelper.c
+ * @author Kevin ioi
+ * @date Oct 2018
+ * @brief File containing the helper functions used to split a mapped vcf file at BEGIN:VCARD
+ *        lines and parse the pieces on a pool of threads, keeping the cards in file order
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include "VCardParser.h"
+#include "CardHelper.h"
+#include "ParallelHelper.h"
+
+//chunks are never made smaller than this, tiny chunks cost more in handoff than they save
+#define MIN_CHUNK_SIZE (64 * 1024)
+
+//chunks per thread, so a chunk full of large PHOTOs only delays the one worker that drew it
+#define CHUNKS_PER_THREAD 4
+
+/*
+  Shared between the workers, next is the index of the next chunk nobody has taken
+*/
+typedef struct chunkQueue {
+  const char      *source;
+  CardChunk       *chunks;
+  size_t          chunkCount;
+  size_t          next;
+  bool            outOfMemory;
+  pthread_mutex_t lock;
+} ChunkQueue;
+
+/**
+* addChunkCard()
+*
+* append to the chunk's own card array, doubling it as needed
+**/
+static bool addChunkCard(CardChunk *chunk, Card *card)
+{
+  Card **temp;//guard against realloc failure
+  size_t newCapacity;
+
+  if (chunk->count == chunk->capacity)
+  {
+    newCapacity = chunk->capacity == 0 ? 16 : chunk->capacity * 2;
+    if ((temp = realloc(chunk->cards, newCapacity * sizeof(Card*))) == NULL)
+      return false;
+    chunk->cards = temp;
+    chunk->capacity = newCapacity;
+  }
+
+  chunk->cards[chunk->count++] = card;
+
+  return true;
+}
+
+/**
+* parseChunk()
+*
+* parse every card in the chunk, the same way nextCard walks a whole file
+**/
+static bool parseChunk(const char *source, CardChunk *chunk)
+{
+  VCardErrorCode parseStatus;
+  size_t lineIndex = chunk->start, cardStart;
+  Card *card;
+
+  //blank lines between or after cards aren't part of any card
+  while ((lineIndex = skipBlankLines(source, chunk->end, lineIndex)) < chunk->end)
+  {
+    cardStart = lineIndex;
+    parseStatus = parseCard(source, chunk->end, &lineIndex, false, &card);
+
+    if (parseStatus == OTHER_ERROR)
+      return false;
+
+    if (!addChunkCard(chunk, card))
+    {
+      deleteCard(card);
+      return false;
+    }
+
+    if (parseStatus != OK)
+    {
+      if (chunk->firstError == OK)
+        chunk->firstError = parseStatus;
+      lineIndex = skipBrokenCard(source, chunk->end, cardStart, lineIndex);
+    }
+  }
+
+  return true;
+}
+
+/**
+* chunkWorker()
+*
+* keep taking the next unparsed chunk until there are none left
+**/
+static void *chunkWorker(void *arg)
+{
+  ChunkQueue *queue = (ChunkQueue*)arg;
+  size_t taken;
+
+  while (true)
+  {
+    pthread_mutex_lock(&queue->lock);
+    taken = queue->outOfMemory ? queue->chunkCount : queue->next++;
+    pthread_mutex_unlock(&queue->lock);
+
+    if (taken >= queue->chunkCount)
+      break;
+
+    if (!parseChunk(queue->source, &queue->chunks[taken]))
+    {
+      pthread_mutex_lock(&queue->lock);
+      queue->outOfMemory = true;
+      pthread_mutex_unlock(&queue->lock);
+    }
+  }
+
+  return NULL;
+}
+
+/**
+* splitChunks()
+*
+* cut source in to pieces of about the same number of bytes, each cut on a BEGIN:VCARD line
+**/
+static CardChunk *splitChunks(const char *source, size_t length, int threadCount, size_t *chunkCount)
+{
+  CardChunk *chunks;
+  size_t maxChunks = (size_t)threadCount * CHUNKS_PER_THREAD;
+  size_t chunkSize = length / maxChunks;
+  size_t start = 0, end;
+
+  if (chunkSize < MIN_CHUNK_SIZE)
+    chunkSize = MIN_CHUNK_SIZE;
+
+  if ((chunks = calloc(maxChunks + 1, sizeof(CardChunk))) == NULL)
+    return NULL;
+
+  *chunkCount = 0;
+  while (start < length)
+  {
+    end = (length - start > chunkSize) ? findNextCard(source, length, start + chunkSize) : length;
+
+    chunks[*chunkCount].start = start;
+    chunks[*chunkCount].end = end;
+    chunks[*chunkCount].firstError = OK;
+    (*chunkCount)++;
+
+    start = end;
+  }
+
+  return chunks;
+}
+
+/**
+* parseCardsParallel()
+*
+* parse every card of source on threadCount threads (0 or less means one per cpu).
+* cards gets one entry per card in file order, NULL for cards that were invalid. Returns
+* the error of the first invalid card, or OTHER_ERROR (and no cards) if memory ran out
+**/
+VCardErrorCode parseCardsParallel(const char *source, size_t length, int threadCount, Card ***cards, size_t *cardCount)
+{
+  ChunkQueue queue;
+  pthread_t *threads;
+  int started = 0, i;
+  size_t chunk, total = 0, j;
+  VCardErrorCode parseStatus = OK;
+
+  *cards = NULL;
+  *cardCount = 0;
+
+  if (source == NULL || length == 0)
+    return OK;
+
+  if (threadCount <= 0)
+    threadCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (threadCount <= 0)
+    threadCount = 1;
+
+  queue.source = source;
+  queue.next = 0;
+  queue.outOfMemory = false;
+  if ((queue.chunks = splitChunks(source, length, threadCount, &queue.chunkCount)) == NULL)
+    return OTHER_ERROR;
+
+  if ((size_t)threadCount > queue.chunkCount)//no point starting threads with nothing to do
+    threadCount = (int)queue.chunkCount;
+
+  if ((threads = malloc(sizeof(pthread_t) * threadCount)) == NULL)
+  {
+    free(queue.chunks);
+    return OTHER_ERROR;
+  }
+  pthread_mutex_init(&queue.lock, NULL);
+
+  for (i = 1; i < threadCount; i++)//this thread is the first worker
+  {
+    if (pthread_create(&threads[i], NULL, chunkWorker, &queue) != 0)
+      break;
+    started++;
+  }
+  chunkWorker(&queue);
+  for (i = 1; i <= started; i++)
+    pthread_join(threads[i], NULL);
+
+  pthread_mutex_destroy(&queue.lock);
+  free(threads);
+
+  for (chunk = 0; chunk < queue.chunkCount; chunk++)
+    total += queue.chunks[chunk].count;
+
+  if (!queue.outOfMemory && (*cards = malloc(sizeof(Card*) * (total > 0 ? total : 1))) == NULL)
+    queue.outOfMemory = true;
+
+  //stitch the chunks back together in file order
+  for (chunk = 0; chunk < queue.chunkCount; chunk++)
+  {
+    for (j = 0; j < queue.chunks[chunk].count; j++)
+    {
+      if (queue.outOfMemory)
+        deleteCard(queue.chunks[chunk].cards[j]);
+      else
+        (*cards)[(*cardCount)++] = queue.chunks[chunk].cards[j];
+    }
+
+    if (parseStatus == OK)
+      parseStatus = queue.chunks[chunk].firstError;
+
+    free(queue.chunks[chunk].cards);
+  }
+  free(queue.chunks);
+
+  if (queue.outOfMemory)
+  {
+    *cardCount = 0;
+    return OTHER_ERROR;
+  }
+
+  return parseStatus;
+}
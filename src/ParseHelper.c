@@ -10,6 +10,9 @@
 #include "ParseHelper.h"
 #include "LinkedListAPI.h"
 #include "PropertyHelper.h"
+#include "FileHelper.h"
+#include "ScanHelper.h"
+#include "InternHelper.h"
 
 /*
 * printString
@@ -45,163 +48,151 @@ int compareString(const void *string1, const void *string2)
 /**
 * strcmpIC()
 *
-* string compare ignore case
+* string compare ignore case, one char at a time so nothing is copied
 *
 **/
 int strcmpIC(const char *string1,const char *string2)
 {
-  char *lowerS1, *lowerS2;
-  int strlen1, strlen2;
-  int i = 0;
-  int result;
+  size_t i;
+  int difference;
 
-  strlen1 = strlen(string1);
-  strlen2 = strlen(string2);
+  for (i = 0; ; i++)
+  {
+    difference = tolower((unsigned char)string1[i]) - tolower((unsigned char)string2[i]);
 
-  lowerS1 = malloc(sizeof(char)*(strlen1 + 1));
-  lowerS2 = malloc(sizeof(char)*(strlen2 + 1));
+    if (difference != 0 || string1[i] == '\0')
+      return difference;
+  }
+}
 
+/**
+* strncmpIC()
+*
+* compare at most n chars ignoring case, string1 does not need to be null terminated
+*
+**/
+int strncmpIC(const char *string1, const char *string2, size_t n)
+{
+  size_t i;
+  int difference;
 
-  for (i = 0; i < strlen1; i++)
+  for (i = 0; i < n; i++)
   {
-    lowerS1[i] = tolower(string1[i]);
+    difference = tolower((unsigned char)string1[i]) - tolower((unsigned char)string2[i]);
+
+    if (difference != 0 || string2[i] == '\0')
+      return difference;
   }
-  lowerS1[i] = '\0';
 
+  return 0;
+}
 
-  for (i = 0; i < strlen2; i++)
-  {
-    lowerS2[i] = tolower(string2[i]);
-  }
-  lowerS2[i] = '\0';
+/**
+* sliceEqualIC()
+*
+* true if the first length chars of slice match all of string, ignoring case
+*
+**/
+bool sliceEqualIC(const char *slice, size_t length, const char *string)
+{
+  return strncmpIC(slice, string, length) == 0 && string[length] == '\0';
+}
+
+/**
+* copySlice()
+*
+* null terminated heap copy of length chars
+*
+**/
+char *copySlice(const char *slice, size_t length)
+{
+  char *copy;
+
+  if ((copy = malloc(length + 1)) == NULL)
+    return NULL;
 
-  result = strcmp(lowerS1, lowerS2);
-  free(lowerS1);
-  free(lowerS2);
+  memcpy(copy, slice, length);
+  copy[length] = '\0';
 
-  return result;
+  return copy;
 }
 
 /**
 * extractProp()
 *
+* points prop at the property name (letters and dashes) at the current index,
+* without copying it, and moves the index past it
 **/
-VCardErrorCode extractProp(char **contentLine, char **prop)
+VCardErrorCode extractProp(ContentLine *line, const char **prop, size_t *propLength)
 {
-  if (contentLine == NULL)
-    return INV_PROP;
-  else if(*contentLine == NULL)
+  size_t i;
+
+  if (line == NULL)
     return INV_PROP;
-  else if (strlen(*contentLine) == 0)
+  else if (line->length == 0 && !line->terminated)
     return INV_PROP;
 
-  int length = strlen(*contentLine);//length of the content line
-  int i = 0;//copying index
-  char *reducedContentLine;
-  char *newProperty;
-
-  if((newProperty = calloc(sizeof(char), 100))==NULL)//allocate room for property
-    return OTHER_ERROR;
+  i = line->index;
 
-  while ((isalpha((*contentLine)[i]) != 0 || (*contentLine)[i] == '-') && i <length)//copy property name until hit punctuation
-  {
-    newProperty[i] = (*contentLine)[i];
+  while (i < line->length && (isalpha((unsigned char)line->text[i]) != 0 || line->text[i] == '-'))//property name runs until punctuation
     i++;
-  }
 
+  if (i == line->length && !line->terminated)//reached end of line, invalid contentLine
+    return INV_PROP;
 
-  if (i < length)//valid read
-  {
-    newProperty[i] = '\0';
+  *prop = &(line->text[line->index]);
+  *propLength = i - line->index;
 
-    if (strcmpIC(newProperty, "END") != 0) {
-      if ((*contentLine)[length-1] != '\n' && (*contentLine)[length-2] != '\r')//invalid line end
-        return INV_PROP;
-    }
+  if (!line->terminated && !sliceEqualIC(*prop, *propLength, "END"))//only END may be missing its line end
+    return INV_PROP;
 
-    if((reducedContentLine = calloc(sizeof(char), strlen(*contentLine) + 1))==NULL)//allocate room for smaller contentLine
-    {
-      free(newProperty);
-      return OTHER_ERROR;
-    }
+  line->index = i;
+
+  return OK;
+}
 
-    strcpy(reducedContentLine, &((*contentLine)[i]));//copy relevent portion of contentLine in to reduced
-    free(*contentLine);
-    *contentLine = reducedContentLine;
+/**
+* findGroup()
+*
+* true if the line starts with a group name (anything up to a dot that comes before the
+* first colon or semi-colon), *groupLength is then its length. Index is not moved
+**/
+bool findGroup(const ContentLine *line, size_t *groupLength)
+{
+  size_t i = line->index;
 
+  i += scanFor(&(line->text[i]), line->length - i, SCAN_DOT | SCAN_COLON | SCAN_SEMICOLON);//find the end of the group name
 
-    *prop = newProperty;
-    return OK;
-  }
-  else//reached end of line, invalid contentLine
+  if (i < line->length && line->text[i] == '.')//proper group format
   {
-    free(newProperty);
-    return INV_PROP;
+    *groupLength = i - line->index;
+    return true;
   }
+
+  return false;
 }
 
 /**
 * extractGroup()
 *
+* interns the group name if the line starts with one, and moves the index past the dot.
+* names too long to intern are copied, in to arena when it isn't NULL
 **/
-VCardErrorCode extractGroup(char **contentLine, char **group)
+VCardErrorCode extractGroup(ContentLine *line, char **group, CardArena *arena)
 {
-  if (contentLine == NULL){
-    *group = NULL;
-    return OTHER_ERROR;//No pointer to contentLine provided
-  }
-  else if(*contentLine == NULL){
-    *group = NULL;
-    return OTHER_ERROR;//No contentLine provided
-  }
-  else if (strlen(*contentLine) == 0){
-    *group = NULL;
-    return OTHER_ERROR;//Empty content line provided
-  }
+  size_t groupLength;
 
-  int i = 0;//counter
-  int length = strlen(*contentLine);
-  char *newGroup;//holds the group string
-  char *temp;//temp string to handle realloc failure
-  char *reducedContentLine;//temp string to help make the content line smaller
+  *group = NULL;
 
-  if((newGroup = malloc(200))==NULL)
-  {
-    *group = NULL;
-    return OTHER_ERROR;
-  }
-
-  while (i < length && (*contentLine)[i] != '.' && (*contentLine)[i] != ':'&& (*contentLine)[i] != ';')//read group name into the string, char by char
-  {
-    newGroup[i] = (*contentLine)[i];
-    i++;
-  }
+  if (line == NULL)
+    return OTHER_ERROR;//No contentLine provided
 
-  if ((*contentLine)[i] == '.')//proper group format
+  if (findGroup(line, &groupLength))
   {
-    newGroup[i] = '\0';
-    if((reducedContentLine = calloc(sizeof(char), strlen(&(*contentLine)[i])+3))==NULL)
-    {
-      free(newGroup);
+    if ((*group = internOrCopy(arena, &(line->text[line->index]), groupLength)) == NULL)
       return OTHER_ERROR;
-    }
-    if ((temp = realloc(newGroup, i+1))==NULL)
-    {
-      free(newGroup);
-      free(reducedContentLine);
-      return OTHER_ERROR;
-    }
-    else
-      newGroup = temp;
-    strcpy(reducedContentLine, &((*contentLine)[i+1]));
-    free(*contentLine);
-    *contentLine = reducedContentLine;
-    *group = newGroup;
-  }
-  else//improper group format or no group found
-  {
-    free(newGroup);
-    *group = NULL;
+
+    line->index += groupLength + 1;
   }
 
   return OK;
@@ -213,12 +204,7 @@ VCardErrorCode extractGroup(char **contentLine, char **group)
 **/
 VCardErrorCode openFileRead(FILE **fp, char *fileName)
 {
-  if (fileName == NULL)//no file address provided
-  {
-    return INV_FILE;
-  }
-
-  if (strcmp(&(fileName[strlen(fileName) - 3]), "vcf") != 0 && strcmp(&(fileName[strlen(fileName) - 5]), "vcard") != 0)//check if valid file extension
+  if (!validFileExtension(fileName))//no file address provided or bad extension
   {
     return INV_FILE;
   }
@@ -236,177 +222,182 @@ VCardErrorCode openFileRead(FILE **fp, char *fileName)
 /**
 * nextContentLine()
 *
+* finds the next content line of source in one pass and describes it as a slice
+* (offset, length, folds) of source, nothing is copied. source is not null
+* terminated, sourceMax is the number of bytes in it
 **/
-VCardErrorCode nextContentLine(char *source, char **nextLine, int *fileIndex)
+VCardErrorCode nextContentLine(const char *source, size_t sourceMax, size_t *fileIndex, LineSlice *slice)
 {
-  int lineStart, lineEnd;//keep track of start and end indexes of the current contentline
-  int lineRead = 0;//dummy variable used to mark when done reading a line
-  int sourceMax = strlen(source);
-  char *tempLine;//used to guard from realloc failure
-  char *tempNxtLine;
-  int memSize = 200;
-
-	if (sourceMax < 20)
-		return INV_FILE;
-  if (*fileIndex >= sourceMax)
-  {
-    *nextLine = NULL;
-    return OK;
-  }
+  size_t lineEnd;//index of the current char being checked
 
-  if((*nextLine = malloc(sizeof(char)*200)) == NULL)
-  {
-    return OTHER_ERROR;
-  }
-  if((tempNxtLine = malloc(sizeof(char)*200)) == NULL)
+  slice->found = false;
+  slice->hasFolds = false;
+  slice->terminated = false;
+
+  if (*fileIndex >= sourceMax)//no lines left
   {
-    free(*nextLine);
-    return OTHER_ERROR;
+    slice->offset = sourceMax;
+    slice->length = 0;
+    return OK;
   }
 
-  strcpy(*nextLine, "");
-
-  lineStart = *fileIndex;
-  lineEnd = lineStart;
+  slice->offset = *fileIndex;
+  lineEnd = *fileIndex;
 
-  if(*fileIndex == 0)//at
+  while (lineEnd < sourceMax)
   {
-    lineEnd++;
-  }
+    lineEnd += scanFor(&(source[lineEnd]), sourceMax - lineEnd, SCAN_CR | SCAN_LF);//jump to the next break
+    if (lineEnd == sourceMax)
+      break;
 
+    if (source[lineEnd] == '\n')//new line without carriage return, error
+      return INV_PROP;
 
-  while (lineRead != 1 && lineEnd != sourceMax)
-  {
-		if(source[lineEnd] == '\n' && source[lineEnd-1] != '\r')//found new line without carriage return, error
-		{
-			free(*nextLine);
-			return INV_PROP;
-		}
-		if(source[lineEnd] == '\r' && source[lineEnd+1] != '\n')//found carriage return without new line, error
-		{
-			free(*nextLine);
-			return INV_PROP;
-		}
-    else if(source[lineEnd] == '\n' && source[lineEnd-1] == '\r')//found a break
+    if (source[lineEnd] == '\r')
     {
-      if (source[lineEnd+1] == ' ' || source[lineEnd+1] == '\t')//folded line found
-      {
-        strncpy(tempNxtLine, &(source[lineStart]), lineEnd-lineStart-1);
-        (tempNxtLine)[lineEnd-lineStart-1] = '\0';
-
-        if((strlen(tempNxtLine)+strlen(*nextLine))>memSize)
-        {
-          if ((tempLine = realloc(*nextLine, memSize+200))==NULL)//realloc space if needed
-          {
-            free(*nextLine);
-            return OTHER_ERROR;
-          }
-          *nextLine = tempLine;
-          memSize += 200;
-        }
-
-        strcat(*nextLine, tempNxtLine);
-        free(tempNxtLine);
-        tempNxtLine = NULL;
-        lineStart = lineEnd+2;
-        if((tempNxtLine = malloc(sizeof(char)*200)) == NULL)
-        {
-          free(*nextLine);
-          return OTHER_ERROR;
-        }
-      }
-      else//line end found
+      if (lineEnd + 1 == sourceMax || source[lineEnd+1] != '\n')//carriage return without new line, error
+        return INV_PROP;
+
+      if (lineEnd + 2 < sourceMax && (source[lineEnd+2] == ' ' || source[lineEnd+2] == '\t'))//folded line found
       {
-        strncpy(tempNxtLine, &(source[lineStart]), lineEnd-lineStart+1);
-        (tempNxtLine)[lineEnd-lineStart+1] = '\0';
-        *fileIndex = lineEnd+1;
-        lineRead = 1;
-        strcat(*nextLine, tempNxtLine);
-        free(tempNxtLine);
-        tempNxtLine = NULL;
+        slice->hasFolds = true;
+        lineEnd += 3;//step over CRLF and the fold whitespace
+        continue;
       }
+
+      slice->terminated = true;//line end found
+      break;
     }
+  }
 
+  slice->found = true;
+  slice->length = lineEnd - slice->offset;
+  *fileIndex = slice->terminated ? lineEnd + 2 : lineEnd;
 
-    lineEnd++;
+  return OK;
+}
+
+/**
+* openContentLine()
+*
+* gets a content line ready to be parsed. Lines without folds are used in place,
+* only folded lines are copied (once) with the folds taken out
+**/
+VCardErrorCode openContentLine(const char *source, const LineSlice *slice, ContentLine *line)
+{
+  char *unfolded;
+
+  if (!slice->hasFolds)
+    return openContentLineWith(source, slice, line, NULL, NULL);
+
+  if ((unfolded = malloc(slice->length)) == NULL)
+    return OTHER_ERROR;
+
+  openContentLineWith(source, slice, line, &unfolded, NULL);
+  line->unfolded = unfolded;//closeContentLine frees it
+
+  return OK;
+}
+
+/**
+* openContentLineWith()
+*
+* openContentLine, but folded lines are unfolded in to *buffer, which is grown as needed
+* and stays with the caller, so checking many lines needs no allocation per line.
+* With a NULL bufferSize *buffer is assumed to be big enough already
+**/
+VCardErrorCode openContentLineWith(const char *source, const LineSlice *slice, ContentLine *line, char **buffer, size_t *bufferSize)
+{
+  const char *raw = &(source[slice->offset]);
+  size_t i, runLength, copyIndex = 0;
+  char *temp;//guard against realloc failure
+
+  line->index = 0;
+  line->terminated = slice->terminated;
+  line->unfolded = NULL;
+
+  if (!slice->hasFolds)
+  {
+    line->text = raw;
+    line->length = slice->length;
+    return OK;
+  }
+
+  if (bufferSize != NULL && *bufferSize < slice->length)
+  {
+    if ((temp = realloc(*buffer, slice->length)) == NULL)
+      return OTHER_ERROR;
+    *buffer = temp;
+    *bufferSize = slice->length;
   }
 
-  if (lineEnd == sourceMax && tempNxtLine != NULL)
+  for (i = 0; i < slice->length; i += 3)//CRLF plus one whitespace char is a fold, drop all three
   {
-    strncpy(tempNxtLine, &(source[lineStart]), lineEnd-lineStart+1);
-    (tempNxtLine)[lineEnd-lineStart+1] = '\0';
-    *fileIndex = lineEnd+1;
-    lineRead = 1;
-    strcat(*nextLine, tempNxtLine);
-    free(tempNxtLine);
+    runLength = scanFor(&(raw[i]), slice->length - i, SCAN_CR);
+    memcpy(&((*buffer)[copyIndex]), &(raw[i]), runLength);
+    copyIndex += runLength;
+    i += runLength;
   }
 
+  line->text = *buffer;
+  line->length = copyIndex;
+
   return OK;
 }
 
+/**
+* closeContentLine()
+*
+**/
+void closeContentLine(ContentLine *line)
+{
+  if (line == NULL)
+    return;
+
+  free(line->unfolded);
+  line->unfolded = NULL;
+  line->text = NULL;
+  line->length = 0;
+}
+
 /**
 * readVCard()
 *
+* reads the rest of fp in to one null terminated string, doubling the buffer
+* as needed and trimming it to size at eof
 **/
 VCardErrorCode readVCard(FILE *fp, char **fileContents)
 {
-  char *fileLine;//to hold file lines as they're read in
   char *tempMem;//holds memory after realloc to check if funtion failed
-  int memSize = 400, fileLength = 0;//keep track of memory allocated and memory used
-  int lineLength;//keep track of how much we're adding to the file
-
-  if ((*fileContents = malloc(400))==NULL)
-  {
-    fclose(fp);
-    return OTHER_ERROR;
-  }
-  strcpy(*fileContents,"");//initialize the string to be ready for strcat
+  size_t memSize = 4096, fileLength = 0;//keep track of memory allocated and memory used
+  size_t chunk;//keep track of how much we're adding to the file
 
-  if ((fileLine = malloc(200))==NULL)
+  if ((*fileContents = malloc(memSize))==NULL)
   {
-    free(*fileContents);
     fclose(fp);
     return OTHER_ERROR;
   }
 
-  while(fgets(fileLine, 200, fp) != NULL)//loop until entire file has been read
+  while((chunk = fread(*fileContents + fileLength, 1, memSize - fileLength - 1, fp)) > 0)//loop until entire file has been read
   {
+    fileLength += chunk;
 
-    lineLength = strlen(fileLine);
-
-    if ((lineLength+fileLength)>= memSize)//realloc if need more memory for line
+    if (fileLength + 1 == memSize)//double memory if buffer is full
     {
-      if((tempMem = realloc(*fileContents, memSize + 400))==NULL)
+      if((tempMem = realloc(*fileContents, memSize * 2))==NULL)
       {
         free(*fileContents);
-        free(fileLine);
         fclose(fp);
         return OTHER_ERROR;
       }
       *fileContents = tempMem;
-      memSize += 400;
-    }
-
-    strcat(*fileContents, fileLine);
-    fileLength+= lineLength;
-
-    free(fileLine);
-    if ((fileLine = malloc(300))==NULL)
-    {
-      free(*fileContents);
-      fclose(fp);
-      return OTHER_ERROR;
+      memSize *= 2;
     }
   }
-  free(fileLine);
+  (*fileContents)[fileLength] = '\0';
 
-  if((tempMem = realloc(*fileContents, strlen(*fileContents)+1))==NULL)
-  {
-    free(*fileContents);
-    fclose(fp);
-    return OTHER_ERROR;
-  }
-  *fileContents = tempMem;
+  if((tempMem = realloc(*fileContents, fileLength+1))!=NULL)
+    *fileContents = tempMem;
 
   fclose(fp);
 
@@ -415,212 +406,162 @@ VCardErrorCode readVCard(FILE *fp, char **fileContents)
 }
 
 /**
-* parseParameters()
+* nextParameter()
 *
+* finds the ;NAME=VALUE pair at the current index without copying it, and moves the index
+* past it. param->found is false once the colon that starts the property values (or the
+* end of the line) is reached
 **/
-VCardErrorCode parseParameters(char ***contentLine, List *paramList)
+VCardErrorCode nextParameter(ContentLine *line, ParameterSlice *param)
 {
-  int contentIndex = 0;//counter for current index of contentLine string
-  int paramIndex = 0;////counter for current index of parametern string
-  int length = strlen(*(*contentLine));//keep track of the length of the content line
-  char *paramName;//holds parmeter name while being built
-  char *paramValue;//char to hold param values
-  char *temp;//used to swap string pointers during realloc, malloc fail guard
-  Parameter *newParam;//parameter object being created
+  const char *text = line->text;
 
-  while (contentIndex < length && (*(*contentLine))[contentIndex] !=':')//read all parameters
-  {
-    if((*(*contentLine))[contentIndex] == ';')//found parameter entry
-    {
-      contentIndex++;//skip over semi-colon
+  param->found = false;
 
-      if((paramName = malloc(sizeof(char)*200))==NULL)
-        return OTHER_ERROR;
+  if (line->index >= line->length || text[line->index] == ':')//no parameters left
+    return OK;
 
-      paramIndex = 0;
-      while ((*(*contentLine))[contentIndex] != '=' && (*(*contentLine))[contentIndex] != '\0')//copy param name char by char
-      {
-        paramName[paramIndex] = (*(*contentLine))[contentIndex];
-        paramIndex++;
-        contentIndex++;
-      }
+  if(text[line->index] != ';')//a colon or semi-colon should be here, right?
+    return INV_PROP;
 
-      if ((*(*contentLine))[contentIndex] == '\0' || contentIndex >= length)
-      {
-        free(paramName);
-        return INV_PROP;
-      }
+  line->index++;//skip over semi-colon
 
-      paramName[paramIndex] = '\0';
-      contentIndex++;//skip over equals sign
-      if((temp = realloc(paramName, sizeof(char)*(strlen(paramName) + 1)))==NULL)
-      {
-        free(paramName);
-        return OTHER_ERROR;
-      }
-      paramName = temp;
+  param->nameStart = line->index;
+  line->index += scanFor(&(text[line->index]), line->length - line->index, SCAN_EQUALS);//find end of param name
 
-      if((paramValue = malloc(200))==NULL)//allocate param value
-      {
-        free(paramName);
-        return OTHER_ERROR;
-      }
-      paramIndex = 0;//reset param index counter to use for param value
-
-        while ((*(*contentLine))[contentIndex] != ':' && (*(*contentLine))[contentIndex] != ';' && (*(*contentLine))[contentIndex] != '\0' && contentIndex < length)//copy param values until hit end quote
-        {
-          paramValue[paramIndex] = (*(*contentLine))[contentIndex];
-          paramIndex++;
-          contentIndex++;
-        }
-        paramValue[paramIndex] = '\0';
-
-        if ((*(*contentLine))[contentIndex] == '\0' || contentIndex >= length)//param values shouldn't go this far...
-        {
-          free(paramValue);
-          free(paramName);
-          return INV_PROP;
-        }
-
-      if((newParam = malloc(sizeof(Parameter)+ paramIndex + 1))==NULL)//allocate param object
-      {
-        free(paramName);
-        free(paramValue);
-        return OTHER_ERROR;
-      }
+  if (line->index >= line->length)
+    return INV_PROP;
 
-      if (strlen(paramName) < 1 || strlen(paramValue) < 1)//invalud param name or value
-      {
-        free(paramName);
-        free(paramValue);
-        return INV_PROP;
-      }
+  param->nameLength = line->index - param->nameStart;
+  line->index++;//skip over equals sign
 
-      strcpy(newParam->name, paramName);
-      free(paramName);
-      strcpy(newParam->value, paramValue);
-      free(paramValue);
+  param->valueStart = line->index;
+  line->index += scanFor(&(text[line->index]), line->length - line->index, SCAN_COLON | SCAN_SEMICOLON);//find end of param value
 
-      insertBack(paramList, newParam);
+  if (line->index >= line->length)//param values shouldn't go this far...
+    return INV_PROP;
 
-      if ((*(*contentLine))[contentIndex] == '"')//jump over second quote if there
-      {
-        contentIndex++;
-        if ((*(*contentLine))[contentIndex] == '\r' || contentIndex >= length)//param values shouldn't go this far...
-          return INV_PROP;
-      }
-    }
-    else//a colon or semi-colon should be here, right?
-    {
-      return INV_PROP;
-    }
-  }
+  param->valueLength = line->index - param->valueStart;
 
-  if((temp = malloc(strlen(&((*(*contentLine))[contentIndex]))+1))==NULL)
-    return OTHER_ERROR;
+  if (param->nameLength < 1 || param->valueLength < 1)//invalid param name or value
+    return INV_PROP;
+
+  if (param->nameLength >= 200)//parameter names are assumed to be shorter than this
+    return INV_PROP;
 
-  //take off the parameter part of the content line
-  strcpy(temp, &((*(*contentLine))[contentIndex]));
-  free((*(*contentLine)));
-  (*(*contentLine)) = temp;
+  param->found = true;
 
   return OK;
 }
 
-VCardErrorCode parsePropertyValues(char ***contentLine, List *propertyList)
+/**
+* parseParameters()
+*
+* reads ;NAME=VALUE pairs until the colon that starts the property values, allocating
+* them from arena when it isn't NULL
+**/
+VCardErrorCode parseParameters(ContentLine *line, List *paramList, CardArena *arena)
 {
-  int contentIndex = 0;//counter for current index of contentLine string
-  int propertyIndex = 0;////counter for current index of parametern string
-  int length = strlen(*(*contentLine));//keep track of the length of the content line
-  char *propertyValue;//holds a property value
-  char *temp;//used to swap string pointers during realloc, malloc fail guard
-
-  if ((*(*contentLine))[contentIndex] == ':')
-    contentIndex++;
+  VCardErrorCode parseStatus;
+  ParameterSlice param;//where the current parameter is in the line
+  const char *text = line->text;
+  Parameter *newParam;//parameter object being created
 
-  while (contentIndex < length && (*(*contentLine))[contentIndex] != '\0' && (*(*contentLine))[contentIndex] != '\r' && (*(*contentLine))[contentIndex] != '\n')//parse entire contentLine
+  while ((parseStatus = nextParameter(line, &param)) == OK && param.found)//read all parameters
   {
-    if((propertyValue = malloc(sizeof(char)*200))==NULL)
+    if((newParam = allocFrom(arena, sizeof(Parameter) + param.valueLength + 1))==NULL)//allocate param object
       return OTHER_ERROR;
 
-    propertyIndex = 0;
-    while ((*(*contentLine))[contentIndex] != '\0' && (*(*contentLine))[contentIndex] != ';' && (*(*contentLine))[contentIndex] != '\r' && (*(*contentLine))[contentIndex] != '\n')
+    if((newParam->name = internOrCopy(arena, &(text[param.nameStart]), param.nameLength))==NULL)//shared with every other param of that name
     {
-
-      //                                                                                          ESCAPING
-      // if ((*(*contentLine))[contentIndex] == '\\')//offset for the escaping of specific chars
-      // {
-      //   contentIndex++;
-      //
-      //   if ((*(*contentLine))[contentIndex] == 'n' || (*(*contentLine))[contentIndex] == 'N')
-      //   {
-      //     propertyValue[propertyIndex] = '\n';
-      //   }
-      //   else if((*(*contentLine))[contentIndex] == '"' || ((*(*contentLine))[contentIndex] == '\\'))
-      //   {
-      //     propertyValue[propertyIndex] =(*(*contentLine))[contentIndex];
-      //   }
-      //   else//whaaaaaa
-      //   {
-      //     propertyValue[propertyIndex] = (*(*contentLine))[contentIndex];//this should probably be an error
-      //   }
-      // }
-      // else
-      // {
-      //   propertyValue[propertyIndex] = (*(*contentLine))[contentIndex];
-      // }
-      //                                                                                          ESCAPING
-
-      propertyValue[propertyIndex] = (*(*contentLine))[contentIndex];
-
-      propertyIndex++;
-      contentIndex++;
+      discardFrom(arena, newParam, free);
+      return OTHER_ERROR;
     }
 
-    propertyValue[propertyIndex] = '\0';
+    memcpy(newParam->value, &(text[param.valueStart]), param.valueLength);
+    newParam->value[param.valueLength] = '\0';
 
-    if ((*(*contentLine))[contentIndex] == ',' || (*(*contentLine))[contentIndex] == ';')
-      contentIndex++;
+    insertBack(paramList, newParam);
+  }
 
-    if((temp = realloc(propertyValue, sizeof(char)*(propertyIndex + 1)))==NULL)
-    {
-      free(propertyValue);
+  return parseStatus;
+}
+
+/**
+* parsePropertyValues()
+*
+* reads the ; separated values that follow the colon, each one copied exactly once
+* (in to arena when it isn't NULL)
+**/
+VCardErrorCode parsePropertyValues(ContentLine *line, List *propertyList, CardArena *arena)
+{
+  size_t valueStart;//first char of the current value
+  const char *text = line->text;
+  char *propertyValue;//holds a property value
+
+  if (line->index < line->length && text[line->index] == ':')
+    line->index++;
+
+  while (line->index < line->length)//parse entire contentLine
+  {
+    valueStart = line->index;
+    line->index += scanFor(&(text[line->index]), line->length - line->index, SCAN_SEMICOLON);
+
+    if((propertyValue = copySliceFrom(arena, &(text[valueStart]), line->index - valueStart))==NULL)
       return OTHER_ERROR;
-    }
-    propertyValue = temp;
 
+    if (line->index < line->length)//step over the semi-colon
+      line->index++;
 
     insertBack(propertyList, propertyValue);
   }
-  if ((*(*contentLine))[contentIndex-1] == ';')
+
+  if (line->index > 0 && text[line->index-1] == ';')//trailing semi-colon means one more empty value
   {
-    if((propertyValue = malloc(1))==NULL)
+    if((propertyValue = copySliceFrom(arena, "", 0))==NULL)
       return OTHER_ERROR;
-    strcpy(propertyValue, "\0");
     insertBack(propertyList, propertyValue);
-
   }
+
   return OK;
 }
 
-char* toStringNoBreak(List * list)
+/**
+* countPropertyValues()
+*
+* how many values parsePropertyValues would read from the line, without copying any.
+* The index is moved to the end of the line the same way
+**/
+int countPropertyValues(ContentLine *line)
 {
-	ListIterator iter = createIterator(list);
-	char* str;
+  const char *text = line->text;
+  int count = 0;
 
-	str = (char*)malloc(sizeof(char));
-	strcpy(str, "");
+  if (line->index < line->length && text[line->index] == ':')
+    line->index++;
 
-	void* elem;
-	while((elem = nextElement(&iter)) != NULL){
-		char* currDescr = list->printData(elem);
-    int newLen = strlen(str)+50+strlen(currDescr);
-		str = (char*)realloc( str, newLen);
-		strcat(str, currDescr);
-    strcat(str, ";");
+  while (line->index < line->length)
+  {
+    line->index += scanFor(&(text[line->index]), line->length - line->index, SCAN_SEMICOLON);
 
-		free(currDescr);
-	}
+    if (line->index < line->length)//step over the semi-colon
+      line->index++;
 
-	return str;
+    count++;
+  }
+
+  if (line->index > 0 && text[line->index-1] == ';')//trailing semi-colon means one more empty value
+    count++;
+
+  return count;
+}
+
+/**
+* toStringNoBreak()
+*
+* every element of list followed by a semicolon, all on one line
+**/
+char* toStringNoBreak(List * list)
+{
+  return joinList(list, ";");
 }
@@ -10,97 +10,62 @@
 #include "LinkedListAPI.h"
 #include "PropertyHelper.h"
 #include "DateHelper.h"
+#include "InternHelper.h"
 
 /*
 * newProperty
 *
+* builds a property from the parameters and values left on the line. name is a
+* slice of the line, group is taken over (freed on error). Names are interned, everything
+* else is allocated from arena when it isn't NULL
 */
-VCardErrorCode newProperty(char *name, char *group, Property **newProp, char **contentLine)
+VCardErrorCode newProperty(const char *name, size_t nameLength, char *group, Property **newProp, ContentLine *contentLine, CardArena *arena)
 {
   VCardErrorCode parseStatus = OK;
 
-  if (name == NULL || (*contentLine) == NULL)
-    return OTHER_ERROR;
-
-  if((*newProp = malloc(sizeof(Property)))== NULL)
+  if (name == NULL || contentLine == NULL)
   {
-    *newProp = NULL;
-    free(name);
-    if (group != NULL)
-      free(group);
+    discardFrom(arena, group, freeName);
     return OTHER_ERROR;
   }
 
-  if(((*newProp)->name = malloc(sizeof(char)*strlen(name)+1))==NULL)//allocate space for name
+  if((*newProp = allocFrom(arena, sizeof(Property)))== NULL)
   {
-    free(newProp);
-    free(name);
-    if (group != NULL)
-      free(group);
+    discardFrom(arena, group, freeName);
     return OTHER_ERROR;
   }
 
-  strcpy((*newProp)->name, name);//copy the property name over
-  free(name);
+  (*newProp)->group = group;
+  (*newProp)->name = NULL;
+  (*newProp)->parameters = NULL;
+  (*newProp)->values = NULL;
 
-  //initialize elements
-  if(((*newProp)->parameters = initializeList(printParameter, deleteParameter, compareParameters))==NULL)
+  if(((*newProp)->name = internOrCopy(arena, name, nameLength))==NULL)//share the property name
   {
-    free((*newProp)->name);
-    free(*newProp);
-    if (group != NULL)
-      free(group);
-    *newProp = NULL;
-    return OTHER_ERROR;
+    parseStatus = OTHER_ERROR;
   }
-  if(((*newProp)->values = initializeList(printString, deleteString, compareString))==NULL)
+  else if ((*newProp)->group == NULL && ((*newProp)->group = internOrCopy(arena, "", 0))==NULL)//no group provided
   {
-    freeList((*newProp)->parameters);
-    free((*newProp)->name);
-    free(*newProp);
-    *newProp = NULL;
-    return OTHER_ERROR;
+    parseStatus = OTHER_ERROR;
   }
-
-  if (group != NULL)//there is a group
+  //initialize elements
+  else if(((*newProp)->parameters = arrayListFrom(arena, printParameter, deleteParameter, compareParameters))==NULL)
   {
-    if(((*newProp)->group = malloc(strlen(group)+1))==NULL)
-    {
-      freeList((*newProp)->values);
-      freeList((*newProp)->parameters);
-      free((*newProp)->name);
-      free(*newProp);
-      *newProp = NULL;
-      return OTHER_ERROR;
-    }
-    strcpy((*newProp)->group, group);
-    (*newProp)->group[strlen(group)] = '\0';
-    free(group);
+    parseStatus = OTHER_ERROR;
   }
-  else//no group provided
+  else if(((*newProp)->values = arrayListFrom(arena, printString, deleteString, compareString))==NULL)
   {
-    if(((*newProp)->group = malloc(1))==NULL)
-    {
-      freeList((*newProp)->values);
-      freeList((*newProp)->parameters);
-      free((*newProp)->name);
-      free(*newProp);
-      *newProp = NULL;
-      return OTHER_ERROR;
-    }
-    strcpy((*newProp)->group, "\0");
+    parseStatus = OTHER_ERROR;
   }
-
-  if((parseStatus =  parseParameters(&contentLine, (*newProp)->parameters ))!=OK)//check for and add parameters to property
+  else if((parseStatus =  parseParameters(contentLine, (*newProp)->parameters, arena))==OK)//check for and add parameters to property
   {
-    deleteProperty(*newProp);
-    return parseStatus;
+    parseStatus =  parsePropertyValues(contentLine, (*newProp)->values, arena);//check for and add values to property
   }
 
-  if((parseStatus =  parsePropertyValues(&contentLine, (*newProp)->values ))!=OK)//check for and add values to property
+  if (parseStatus != OK)
   {
-    deleteProperty(*newProp);
-    return parseStatus;
+    discardFrom(arena, *newProp, deleteProperty);
+    *newProp = NULL;
   }
 
   return parseStatus;
@@ -112,8 +77,8 @@ Property *createProperty()
   Property *newProp;
 
   newProp = malloc(sizeof(Property));
-  newProp->parameters = initializeList(printParameter, deleteParameter, compareParameters);
-  newProp->values = initializeList(printString, deleteString, compareString);
+  newProp->parameters = initializeArrayList(printParameter, deleteParameter, compareParameters);
+  newProp->values = initializeArrayList(printString, deleteString, compareString);
 
   return newProp;
 }
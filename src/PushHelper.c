@@ -0,0 +1,277 @@
+/**
+ * @file PushHelper.c
+ * @author Kevin ioi
+ * @date Oct 2018
+ * @brief File containing the push parser, which is handed a vcf stream a fragment at a time
+ *        (socket reads, pipe reads) and builds each card as its lines arrive. Whole lines are
+ *        parsed straight out of the fragment, only a line cut off at the end of a fragment is
+ *        copied, so memory is bounded by the longest content line
+ */
+
+#include "VCardParser.h"
+#include "ParseHelper.h"
+#include "CardHelper.h"
+#include "ScanHelper.h"
+#include "PushHelper.h"
+
+/**
+* appendPending()
+*
+* add bytes to the end of the cut off line, doubling the buffer as needed
+**/
+static bool appendPending(VCardPushParser *parser, const char *bytes, size_t length)
+{
+  char *temp;//guard against realloc failure
+  size_t newSize = parser->pendingSize == 0 ? 256 : parser->pendingSize;
+
+  while (newSize < parser->pendingLength + length)
+    newSize *= 2;
+
+  if (newSize != parser->pendingSize)
+  {
+    if ((temp = realloc(parser->pending, newSize)) == NULL)
+      return false;
+    parser->pending = temp;
+    parser->pendingSize = newSize;
+  }
+
+  memcpy(&(parser->pending[parser->pendingLength]), bytes, length);
+  parser->pendingLength += length;
+
+  return true;
+}
+
+/**
+* pendingEndsLine()
+*
+* true if the cut off line ends with CRLF, so only the next char can say whether it is folded
+**/
+static bool pendingEndsLine(const VCardPushParser *parser)
+{
+  return parser->pendingLength >= 2 && parser->pending[parser->pendingLength-2] == '\r' &&
+         parser->pending[parser->pendingLength-1] == '\n';
+}
+
+/**
+* lineError()
+*
+* the current card is invalid, drop it and ignore lines until the next BEGIN:VCARD
+**/
+static VCardErrorCode lineError(VCardPushParser *parser, VCardErrorCode parseStatus)
+{
+  if (parser->skipping)//card was already thrown away
+    return OK;
+
+  clearCardBuilder(&parser->builder);
+  parser->skipping = true;
+
+  return parseStatus;
+}
+
+/**
+* pushLine()
+*
+* give one complete content line to the card being built, and the card to the caller once
+* its END:VCARD line arrives. A BEGIN:VCARD that cuts the card short fails it, and then
+* starts the next card rather than being skipped over
+**/
+static VCardErrorCode pushLine(VCardPushParser *parser, const char *source, const LineSlice *slice)
+{
+  VCardErrorCode parseStatus;
+  ContentLine contentLine;
+  Card *card = NULL;
+  BuildStage stage = parser->builder.stage;
+
+  //blank lines between or after cards aren't part of any card
+  if (stage == EXPECT_BEGIN && skipBlankLines(&(source[slice->offset]), slice->length, 0) == slice->length)
+    return OK;
+
+  if (parser->skipping)
+  {
+    if (slice->length < 11 || strncmpIC(&(source[slice->offset]), "BEGIN:VCARD", 11) != 0)
+      return OK;
+    parser->skipping = false;
+  }
+
+  if ((parseStatus = openContentLine(source, slice, &contentLine)) != OK)
+    return lineError(parser, parseStatus);
+
+  parseStatus = addCardLine(&parser->builder, &contentLine, &card);
+
+  if (parseStatus != OK && stage != EXPECT_BEGIN && beginsCard(&contentLine))//card has no END:VCARD
+  {
+    if (addCardLine(&parser->builder, &contentLine, &card) != OK)//builder was cleared, start over with this line
+      parseStatus = lineError(parser, parseStatus);
+
+    closeContentLine(&contentLine);
+    return parseStatus;
+  }
+
+  closeContentLine(&contentLine);
+
+  if (parseStatus != OK)
+    return lineError(parser, parseStatus);
+
+  if (card != NULL)
+    parser->onCard(card, parser->context);
+
+  return OK;
+}
+
+/**
+* pushPending()
+*
+* the cut off line is complete, parse it and empty the buffer
+**/
+static VCardErrorCode pushPending(VCardPushParser *parser)
+{
+  VCardErrorCode parseStatus;
+  LineSlice slice;
+  size_t lineIndex = 0;
+
+  parseStatus = nextContentLine(parser->pending, parser->pendingLength, &lineIndex, &slice);
+  parser->pendingLength = 0;//bytes stay put until the next append
+
+  if (parseStatus != OK)
+    return lineError(parser, parseStatus);
+
+  if (!slice.found)
+    return OK;
+
+  return pushLine(parser, parser->pending, &slice);
+}
+
+VCardErrorCode vcardParserOpen(void (*onCard)(Card* card, void* context), void* context, VCardPushParser** parser)
+{
+  VCardPushParser *newParser;
+
+  if (parser == NULL)
+    return OTHER_ERROR;
+  *parser = NULL;
+
+  if (onCard == NULL)
+    return OTHER_ERROR;
+
+  if ((newParser = malloc(sizeof(VCardPushParser))) == NULL)
+    return OTHER_ERROR;
+
+  startCardBuilder(&newParser->builder, false);
+  newParser->pending = NULL;
+  newParser->pendingLength = 0;
+  newParser->pendingSize = 0;
+  newParser->skipping = false;
+  newParser->onCard = onCard;
+  newParser->context = context;
+
+  *parser = newParser;
+
+  return OK;
+}
+
+VCardErrorCode vcardParserFeed(VCardPushParser* parser, const char* bytes, size_t length)
+{
+  VCardErrorCode parseStatus, firstError = OK;
+  LineSlice slice;
+  size_t index = 0, lineIndex, take, scanLength;
+
+  if (parser == NULL || (bytes == NULL && length > 0))
+    return OTHER_ERROR;
+
+  //a CR as the very last byte may be half of a CRLF, it is never tokenized until the LF shows up
+  scanLength = (length > 0 && bytes[length-1] == '\r') ? length - 1 : length;
+
+  while (index < length)
+  {
+    parseStatus = OK;
+
+    if (parser->pendingLength > 0)//finish the line left over from the last fragment first
+    {
+      if (pendingEndsLine(parser) && bytes[index] != ' ' && bytes[index] != '\t')
+      {
+        parseStatus = pushPending(parser);//next char isn't a fold, the line is complete
+      }
+      else//line carries on, take the fragment up to and including its next LF
+      {
+        take = scanFor(&(bytes[index]), length - index, SCAN_LF);
+        take = (index + take < length) ? take + 1 : length - index;
+
+        if (!appendPending(parser, &(bytes[index]), take))
+          return OTHER_ERROR;
+        index += take;
+
+        if (parser->pending[parser->pendingLength-1] == '\n' && !pendingEndsLine(parser))
+          parseStatus = pushPending(parser);//new line without carriage return, let the tokenizer report it
+      }
+    }
+    else//nothing pending, whole lines are parsed in place
+    {
+      lineIndex = index;
+      parseStatus = nextContentLine(bytes, scanLength, &lineIndex, &slice);
+
+      if (parseStatus != OK)//stray CR or LF, drop the rest of the line
+      {
+        take = scanFor(&(bytes[index]), length - index, SCAN_LF);
+
+        if (index + take < length)
+        {
+          index += take + 1;
+          parseStatus = lineError(parser, parseStatus);
+        }
+        else if (!appendPending(parser, &(bytes[index]), length - index))//line isn't over yet
+        {
+          return OTHER_ERROR;
+        }
+        else
+        {
+          index = length;
+          parseStatus = OK;
+        }
+      }
+      else if (slice.found && slice.terminated && lineIndex < length)//line and the char after it are both here
+      {
+        parseStatus = pushLine(parser, bytes, &slice);
+        index = lineIndex;
+      }
+      else//line is cut off, or ends exactly at the end of the fragment and may still be folded
+      {
+        if (!appendPending(parser, &(bytes[index]), length - index))
+          return OTHER_ERROR;
+        index = length;
+      }
+    }
+
+    if (firstError == OK)
+      firstError = parseStatus;
+  }
+
+  return firstError;
+}
+
+VCardErrorCode vcardParserFinish(VCardPushParser* parser)
+{
+  VCardErrorCode parseStatus = OK;
+
+  if (parser == NULL)
+    return OTHER_ERROR;
+
+  if (parser->pendingLength > 0)//last line, which doesn't need a CRLF
+    parseStatus = pushPending(parser);
+
+  if (parseStatus == OK && parser->builder.stage != EXPECT_BEGIN)//stream ended part way through a card
+    parseStatus = INV_CARD;
+
+  clearCardBuilder(&parser->builder);
+  parser->skipping = false;
+
+  return parseStatus;
+}
+
+void vcardParserClose(VCardPushParser* parser)
+{
+  if (parser == NULL)
+    return;
+
+  clearCardBuilder(&parser->builder);
+  free(parser->pending);
+  free(parser);
+}
@@ -0,0 +1,216 @@
+/**
+ * @file ScanHelper.c
+ * @author Kevin ioi
+ * @date Sept 2018
+ * @brief File containing the helper functions used to find CRLFs and delimiters a block at a
+ *        time. SSE2 is the baseline on x86-64, AVX2 is used when the cpu has it, anything
+ *        else falls back to checking one char at a time
+ */
+
+#include <stdbool.h>
+
+#include "ScanHelper.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+#define SCAN_BLOCK 32
+
+//class bit of every char, 0 for chars that aren't structural
+static const unsigned char charClass[256] = {
+  ['\r'] = SCAN_CR, ['\n'] = SCAN_LF, ['.'] = SCAN_DOT,
+  [';'] = SCAN_SEMICOLON, [':'] = SCAN_COLON, ['='] = SCAN_EQUALS,
+  ['\"'] = SCAN_QUOTE, ['\\'] = SCAN_BACKSLASH
+};
+
+/**
+* scalarScan()
+*
+* one char at a time, for scans too short to fill a block
+**/
+static size_t scalarScan(const char *data, size_t length, unsigned classes)
+{
+  size_t i;
+
+  for (i = 0; i < length; i++)
+  {
+    if (charClass[(unsigned char)data[i]] & classes)
+      return i;
+  }
+
+  return length;
+}
+
+#ifdef SCAN_X86
+
+//one byte to compare against per class, same order as the SCAN_ bits
+static const char scanChars[] = {'\r', '\n', '.', ';', ':', '=', '\"', '\\'};
+#define SCAN_CLASSES ((int)sizeof(scanChars))
+
+/**
+* useAVX2()
+*
+* the cpu features are read once at startup by the compiler runtime, so this is just a load
+**/
+static bool useAVX2(void)
+{
+  return __builtin_cpu_supports("avx2");
+}
+
+/**
+* sse2Mask()
+*
+* bitmask for 32 bytes, two 16 byte compares per class
+**/
+static uint32_t sse2Mask(const char *block, unsigned classes)
+{
+  __m128i low = _mm_loadu_si128((const __m128i*)block);
+  __m128i high = _mm_loadu_si128((const __m128i*)(block + 16));
+  __m128i lowHits = _mm_setzero_si128();
+  __m128i highHits = _mm_setzero_si128();
+  __m128i target;
+  int c;
+
+  for (c = 0; c < SCAN_CLASSES; c++)
+  {
+    if (classes & (1u << c))
+    {
+      target = _mm_set1_epi8(scanChars[c]);
+      lowHits = _mm_or_si128(lowHits, _mm_cmpeq_epi8(low, target));
+      highHits = _mm_or_si128(highHits, _mm_cmpeq_epi8(high, target));
+    }
+  }
+
+  return (uint32_t)_mm_movemask_epi8(lowHits) | ((uint32_t)_mm_movemask_epi8(highHits) << 16);
+}
+
+/**
+* avx2Mask()
+*
+* bitmask for 32 bytes, one compare per class
+**/
+__attribute__((target("avx2")))
+static uint32_t avx2Mask(const char *block, unsigned classes)
+{
+  __m256i bytes = _mm256_loadu_si256((const __m256i*)block);
+  __m256i hits = _mm256_setzero_si256();
+  int c;
+
+  for (c = 0; c < SCAN_CLASSES; c++)
+  {
+    if (classes & (1u << c))
+      hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(scanChars[c])));
+  }
+
+  return (uint32_t)_mm256_movemask_epi8(hits);
+}
+
+/**
+* avx2Scan()
+*
+* kept separate from scanFor so the whole loop is compiled for avx2
+**/
+__attribute__((target("avx2")))
+static size_t avx2Scan(const char *data, size_t length, unsigned classes)
+{
+  size_t offset = 0;
+  uint32_t mask;
+
+  if (length < SCAN_BLOCK)
+    return scalarScan(data, length, classes);
+
+  while (offset + SCAN_BLOCK <= length)
+  {
+    if ((mask = avx2Mask(&data[offset], classes)) != 0)
+      return offset + __builtin_ctz(mask);
+    offset += SCAN_BLOCK;
+  }
+
+  if (offset == length)
+    return length;
+
+  //last partial block: re-read the final 32 bytes and ignore the ones already checked
+  mask = avx2Mask(&data[length - SCAN_BLOCK], classes) >> (offset - (length - SCAN_BLOCK));
+
+  return mask != 0 ? offset + __builtin_ctz(mask) : length;
+}
+
+#else
+
+/**
+* scalarMask()
+*
+* bitmask of the chars of block[0..length) that fall in classes, length <= 32
+**/
+static uint32_t scalarMask(const char *block, size_t length, unsigned classes)
+{
+  uint32_t mask = 0;
+  size_t i;
+
+  for (i = 0; i < length; i++)
+  {
+    if (charClass[(unsigned char)block[i]] & classes)
+      mask |= (uint32_t)1 << i;
+  }
+
+  return mask;
+}
+
+#endif
+
+/**
+* classifyBlock()
+*
+* bitmask of which of the SCAN_BLOCK (32) bytes starting at block are in classes,
+* bit i set means block[i] is one of the requested chars. block must have 32 readable bytes
+**/
+uint32_t classifyBlock(const char *block, unsigned classes)
+{
+#ifdef SCAN_X86
+  if (useAVX2())
+    return avx2Mask(block, classes);
+
+  return sse2Mask(block, classes);
+#else
+  return scalarMask(block, SCAN_BLOCK, classes);
+#endif
+}
+
+/**
+* scanFor()
+*
+* index of the first char of data[0..length) in classes, or length if there isn't one.
+* never reads past data[length-1]
+**/
+size_t scanFor(const char *data, size_t length, unsigned classes)
+{
+#ifdef SCAN_X86
+  size_t offset = 0;
+  uint32_t mask;
+
+  if (useAVX2())
+    return avx2Scan(data, length, classes);
+
+  if (length < SCAN_BLOCK)
+    return scalarScan(data, length, classes);
+
+  while (offset + SCAN_BLOCK <= length)
+  {
+    if ((mask = sse2Mask(&data[offset], classes)) != 0)
+      return offset + __builtin_ctz(mask);
+    offset += SCAN_BLOCK;
+  }
+
+  if (offset == length)
+    return length;
+
+  //last partial block: re-read the final 32 bytes and ignore the ones already checked
+  mask = sse2Mask(&data[length - SCAN_BLOCK], classes) >> (offset - (length - SCAN_BLOCK));
+
+  return mask != 0 ? offset + __builtin_ctz(mask) : length;
+#else
+  return scalarScan(data, length, classes);
+#endif
+}
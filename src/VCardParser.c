@@ -12,6 +12,12 @@
 #include "PropertyHelper.h"
 #include "DateHelper.h"
 #include "ValidationHelper.h"
+#include "FileHelper.h"
+#include "ParallelHelper.h"
+#include "ArenaHelper.h"
+#include "InternHelper.h"
+#include "JSONHelper.h"
+#include "JSONParseHelper.h"
 
 
 VCardErrorCode validateCard(const Card* obj)
@@ -35,7 +41,7 @@ VCardErrorCode validateCard(const Card* obj)
       return INV_CARD;
     if (getLength(obj->fn->values)>1)
       return INV_CARD;
-    if(strcmpIC(obj->fn->name, "FN") != 0)
+    if(propertyID(obj->fn->name, strlen(obj->fn->name)) != FN)
       return INV_CARD;
   }
 
@@ -43,45 +49,8 @@ VCardErrorCode validateCard(const Card* obj)
   if (obj->optionalProperties == NULL)
     return INV_CARD;
 
-  //initialize the list used to track the number of specific properties in vCard
-  List *propertyCounts =  initializeList(printPropNode,deletePropNode,cmpPropNode);
-  loadPropertyCounter(propertyCounts);
-
-  ListIterator itr = createIterator(obj->optionalProperties);
-  Property *tempProp;
-  while ((tempProp = (Property*)nextElement(&itr)) != NULL)//validate all property objects in optionalProperties
-  {
-    if((validationStatus = validateProp(tempProp, propertyCounts))!=OK)
-    {
-      freeList(propertyCounts);
-      return validationStatus;
-    }
-  }
-
-  if (countProperty("MEMBER", propertyCounts))//MEMBER 3 exists, KIND property MUST be group
-  {
-    itr = createIterator(obj->optionalProperties);
-    while ((tempProp = (Property*)nextElement(&itr)) != NULL)//validate all property objects in optionalProperties
-    {
-      validationStatus = INV_CARD;
-      if (strcmpIC(tempProp->name, "KIND")==0)
-      {
-        if (strcmpIC((char*)(tempProp->values->head->data), "group") == 0)
-        {
-          validationStatus = OK;
-          break;
-        }
-      }
-    }
-
-    if(validationStatus != OK)
-    {
-      freeList(propertyCounts);
-      return validationStatus;
-    }
-  }
-
-  freeList(propertyCounts);
+  if ((validationStatus = validateProperties(obj)) != OK)
+    return validationStatus;
 
   if (obj->birthday != NULL)//validate birthday
   {
@@ -101,7 +70,7 @@ VCardErrorCode validateCard(const Card* obj)
 VCardErrorCode writeCard(const char* fileName, const Card* obj)
 {
   VCardErrorCode parseStatus;
-  char *tempContentLine;
+  OutBuffer out;//the whole card, written to the file in one go
   FILE *fp;
 
   if (obj == NULL)//no card provided
@@ -114,925 +83,491 @@ VCardErrorCode writeCard(const char* fileName, const Card* obj)
   if((parseStatus = openFileWrite(&fp, fileName)) != OK)
     return parseStatus;
 
-  fprintf(fp, "BEGIN:VCARD\r\nVERSION:4.0\r\n");//hardcoded header for vCard
-
-  if((parseStatus = writeProperty(&fp, obj->fn))!= OK)
+  if (!startOutBuffer(&out, 4096))
   {
     fclose(fp);
-    return parseStatus;
+    return WRITE_ERROR;
   }
 
-  writeOptionalProps(&fp, obj->optionalProperties);
+  if ((parseStatus = writeCardTo(&out, obj)) == OK && fwrite(out.data, 1, out.length, fp) != out.length)
+    parseStatus = WRITE_ERROR;
+
+  freeOutBuffer(&out);
 
-  if (obj->anniversary != NULL) {
-    tempContentLine = malloc(200);
-    strcpy(tempContentLine, "ANNIVERSARY");
-    parseStatus = writeDateTime(&tempContentLine, obj->anniversary);
-    fprintf(fp, "%s\r\n", tempContentLine);
-    free(tempContentLine);
-  }
+  if (fclose(fp) != 0 && parseStatus == OK)
+    parseStatus = WRITE_ERROR;
+
+  return parseStatus;
+}
 
-  if (obj->birthday != NULL) {
-  tempContentLine = malloc(200);
-  strcpy(tempContentLine, "BDAY");
-  parseStatus = writeDateTime(&tempContentLine, obj->birthday);
-  fprintf(fp, "%s\r\n", tempContentLine);
-  free(tempContentLine);
+VCardErrorCode serializeCard(const Card* obj, char** out, size_t* length)
+{
+  VCardErrorCode parseStatus;
+  OutBuffer buffer;
+  char *temp;//guard against realloc failure
+
+  if (out == NULL || length == NULL)
+    return WRITE_ERROR;
+  *out = NULL;
+  *length = 0;
+
+  if (obj == NULL)//no card provided
+    return WRITE_ERROR;
+
+  if (!startOutBuffer(&buffer, 4096))
+    return WRITE_ERROR;
+
+  if ((parseStatus = writeCardTo(&buffer, obj)) != OK || !appendBytes(&buffer, "", 1))//null terminated for convenience
+  {
+    freeOutBuffer(&buffer);
+    return WRITE_ERROR;
   }
 
-  fprintf(fp, "END:VCARD\r\n");
+  if ((temp = realloc(buffer.data, buffer.length)) != NULL)//give back the unused part
+    buffer.data = temp;
 
-  fclose(fp);
+  *out = buffer.data;
+  *length = buffer.length - 1;
 
   return OK;
 }
 
+VCardErrorCode writeCards(int fd, Card** cards, size_t cardCount)
+{
+  if (fd < 0 || (cards == NULL && cardCount > 0))
+    return WRITE_ERROR;
+
+  return writeCardBatch(fd, cards, cardCount);
+}
+
 VCardErrorCode createCard(char* fileName, Card** newCardObject)
 {
-  FILE *fp;//file pointer to be read in
+  VCardBuffer vCardFile;//the whole file, mapped read-only
   VCardErrorCode parseStatus;//the current status of the parsing
-  int lineIndex = 0;//the current index of the vCardString being process
-  int maxIndex;
-  int endFound = 0;
-  Card *newCard;//the card object that is to be returned
-  char *vCardString;//all of the vcard contentLines read in
-  char *contentLine;//used to perform comparision checks against strings
-  char *group;//string to hold a property's group strings, if found
-  char *propName;//string to hold a property name as it is taken from content line
-  Property *prop;//property object handler
-  DateTime *newDT;//handler for new datetime objects
-
-  //initialize the VCard
-  if((newCard = initializeCard(printProperty, deleteProperty, compareProperties)) == NULL)
-  {
-    *newCardObject = NULL;
-    parseStatus = OTHER_ERROR;
-    return parseStatus;
-  }
+  size_t lineIndex = 0;//the current index of the vCardString being process
 
-  //check validity of provided file address
-  if((parseStatus = openFileRead(&fp, fileName)) != OK)
+  //check validity of provided file address and map the file
+  if((parseStatus = mapVCardFile(fileName, &vCardFile)) != OK)
   {
-    deleteCard(newCard);
     *newCardObject = NULL;
     return parseStatus;
   }
 
-  //read all of the data in the file into vCardString
-  if((parseStatus = readVCard(fp, &vCardString)) != OK)
+  if (vCardFile.length < 40)//vcard is too short to be valid
   {
-    deleteCard(newCard);
+    unmapVCardFile(&vCardFile);
     *newCardObject = NULL;
-    return parseStatus;
+    return INV_CARD;
   }
 
-  maxIndex = strlen(vCardString);
+  parseStatus = parseCard(vCardFile.data, vCardFile.length, &lineIndex, false, newCardObject);
 
-  if (maxIndex < 40)//vcard is too short to be valid
-  {
-    deleteCard(newCard);
-    free(vCardString);
-    *newCardObject = NULL;
-    return INV_CARD;
-  }
+  unmapVCardFile(&vCardFile);
 
-  //make sure the begin tag starts the file
-  if((parseStatus = nextContentLine(vCardString, &contentLine, &lineIndex))!=OK)
-  {
-    deleteCard(newCard);
-    free(vCardString);
-    *newCardObject = NULL;
-    return parseStatus;
-  }
-  if (strcmpIC(contentLine, "BEGIN:VCARD\r\n") != 0)
-  {
-    deleteCard(newCard);
-    free(contentLine);
-    free(vCardString);
-    *newCardObject = NULL;
-    parseStatus = INV_CARD;
-    return parseStatus;
-  }
-  free(contentLine);
+  return parseStatus;
+}
 
-  //make sure the vcard is version 4.0
-  if((parseStatus = nextContentLine(vCardString, &contentLine, &lineIndex)) != OK)
-  {
-    deleteCard(newCard);
-    free(vCardString);
-    *newCardObject = NULL;
-    return parseStatus;
-  }
+VCardErrorCode createCardInArena(char* fileName, Card** newCardObject)
+{
+  VCardBuffer vCardFile;
+  VCardErrorCode parseStatus;
+  size_t lineIndex = 0;
 
-  if (strcmpIC(contentLine, "VERSION:4.0\r\n") != 0)
-  {
-    free(contentLine);
-    deleteCard(newCard);
-    free(vCardString);
-    *newCardObject = NULL;
-    parseStatus = INV_CARD;
+  if (newCardObject == NULL)
+    return OTHER_ERROR;
+  *newCardObject = NULL;
+
+  if((parseStatus = mapVCardFile(fileName, &vCardFile)) != OK)
     return parseStatus;
-  }
-  free(contentLine);
 
+  if (vCardFile.length < 40)//vcard is too short to be valid
+    parseStatus = INV_CARD;
+  else
+    parseStatus = parseCard(vCardFile.data, vCardFile.length, &lineIndex, true, newCardObject);
 
-  parseStatus = nextContentLine(vCardString, &contentLine, &lineIndex);//get first regular content line
+  unmapVCardFile(&vCardFile);
 
-  while (parseStatus == OK && contentLine!=NULL)//parse file unless error or hits eof
-  {
-    group = NULL;
-    propName = NULL;
+  return parseStatus;
+}
 
-    if(endFound == 1)//parser already found end flag, shouldn't have been more to read
-    {
-      parseStatus = INV_CARD;
-    }
+VCardErrorCode validateVCardFile(const char* fileName)
+{
+  VCardBuffer vCardFile;
+  VCardErrorCode parseStatus;
+  size_t lineIndex = 0;
 
-    if((parseStatus = extractGroup(&contentLine, &group))== OK)
-    {
-      if((parseStatus = extractProp(&contentLine, &propName))==OK)
-      {
-        if(strcmpIC(propName, "bday") == 0)//found bday property
-        {
-          if (newCard->birthday != NULL)//found multiple birthday properties
-          {
-            free(propName);
-            if(group!= NULL)
-              free(group);
-            group=NULL;
-            parseStatus = INV_CARD;
-          }
-          else
-          {
-            free(propName);
-
-            if (group != NULL)
-              free(group);
-            group = NULL;
-            parseStatus = newDate(&newDT, &contentLine);
-
-            if (parseStatus == OK)
-              newCard->birthday = newDT;
-          }
-        }
-        else if(strcmpIC(propName, "ANNIVERSARY") == 0)//found Anniversary property
-        {
-          if (newCard->anniversary != NULL)//found multiple anniversary properties
-          {
-            free(propName);
-            if(group!= NULL)
-              free(group);
-            group=NULL;
-            parseStatus = INV_CARD;
-          }
-          else
-          {
-            free(propName);
-            if (group != NULL)
-              free(group);
-            group = NULL;
-            parseStatus = newDate(&newDT, &contentLine);
-
-            if (parseStatus == OK)
-              newCard->anniversary = newDT;
-          }
-        }
-        else if (strcmpIC(propName, "END")==0)//found end flag
-        {
-
-          if (strcmpIC(contentLine, ":VCARD\r\n")==0 || strcmpIC(contentLine, ":VCARD")==0)
-            endFound = 1;
-          else
-            parseStatus = INV_CARD;
-
-          free(propName);
-          propName = NULL;
-          if(group != NULL)
-            free(group);
-          group = NULL;
-          free(contentLine);
-          break;
-        }
-        else if (strcmpIC(propName, "BEGIN")==0)//found another begin flag
-        {
-          free(propName);
-          if (group != NULL)
-          {
-            free(group);
-          }
-          parseStatus = INV_CARD;
-        }
-        else//have standard property type
-        {
-          if (strlen(propName) < 1 )
-          {
-            free(propName);
-            parseStatus = INV_PROP;
-          }
-          else if((parseStatus = newProperty(propName, group, &prop, &contentLine))==OK)//build property
-          {
-            if(getLength(prop->values)==0)//make sure the property had a value
-            {
-              deleteProperty(prop);
-              parseStatus = INV_PROP;
-            }
-            else if (strcmpIC(prop->name, "n")==0 && getLength(prop->values) != 5) {//check if name property had enough values
-              deleteProperty(prop);
-              parseStatus = INV_PROP;
-            }
-            else if (strcmpIC(prop->name, "ADR")==0 && getLength(prop->values) != 7) {//check if address property had enough values
-              deleteProperty(prop);
-              parseStatus = INV_PROP;
-            }
-            else if (strcmpIC(prop->name, "fn") == 0 && newCard->fn ==NULL)//new FN property
-            {
-              newCard->fn = prop;
-            }
-            else//optional property
-            {
-              insertBack(newCard->optionalProperties, prop);
-            }
-          }
-        }
-      }
-    }
+  if((parseStatus = mapVCardFile(fileName, &vCardFile)) != OK)
+    return parseStatus;
 
+  if (vCardFile.length < 40)//vcard is too short to be valid
+    parseStatus = INV_CARD;
+  else
+    parseStatus = checkCard(vCardFile.data, vCardFile.length, &lineIndex);
 
-    free(contentLine);
-    if (parseStatus == OK)
-    {
-      parseStatus = nextContentLine(vCardString, &contentLine, &lineIndex);//get next content line
-    }
-  }
+  unmapVCardFile(&vCardFile);
 
-  free(vCardString);
+  return parseStatus;
+}
 
-  if (parseStatus == OK)
-   {
-     if (endFound != 1)// didn't find end flag, error
-      parseStatus = INV_CARD;
+VCardErrorCode validateVCardBuffer(const char* data, size_t length)
+{
+  size_t lineIndex = 0;
 
-     if(newCard->fn  == NULL)
-      parseStatus = INV_CARD;
-  }
+  if (data == NULL)
+    return INV_FILE;
 
-  if(parseStatus!=OK)
-  {
-    deleteCard(newCard);
-    *newCardObject = NULL;
-  }
-  else
-    *newCardObject = newCard;
+  if (length < 40)//vcard is too short to be valid
+    return INV_CARD;
 
-  return parseStatus;
+  return checkCard(data, length, &lineIndex);
 }
 
-char* strListToJSON(const List* strList)
+const char* internName(const char* name)
 {
-  if (strList == NULL)
+  if (name == NULL)
     return NULL;
 
-  ListIterator iter = createIterator((List*)strList);
-  int jsonIndex = 0;
-  int strIndex = 0;
-  int memAllocd = 400;
-  int strSize;
-  char *json = calloc(400, sizeof(char));
-  char *tempStr;
-
-  json[jsonIndex] = '[';//start json
-  jsonIndex++;
-  while ((tempStr = (char*)nextElement(&iter)) != NULL)
-  {
-    strIndex = 0;
-    strSize = (int)strlen(tempStr);
+  return internSlice(name, strlen(name));
+}
 
-    //if new string is too big to hold in allocd mem
-    if (strlen(json) + strSize >= memAllocd*sizeof(char))
-    {
-      json = realloc(json, (memAllocd+strSize+200)*sizeof(char));
-      memAllocd += 200+strSize;
-    }
+VCardErrorCode createCardFromBuffer(const char* data, size_t length, Card** newCardObject)
+{
+  size_t lineIndex = 0;
 
-    json[jsonIndex] = '\"';
-    jsonIndex++;
+  if (newCardObject == NULL)
+    return OTHER_ERROR;
+  *newCardObject = NULL;
 
-    for (strIndex = 0; strIndex < strSize; strIndex++)//copy str in char by char
-    {
-      if (tempStr[strIndex] == '\"')//catch escaped quotes
-      {
-        json[jsonIndex] = '\\';
-        jsonIndex++;
-      }
-      json[jsonIndex] = tempStr[strIndex];
-      jsonIndex++;
-    }
+  if (data == NULL)
+    return INV_FILE;
 
-    json[jsonIndex] = '\"';
-    jsonIndex++;
-    json[jsonIndex] = ',';
-    jsonIndex++;
-  }
+  if (length < 40)//vcard is too short to be valid
+    return INV_CARD;
+
+  return parseCard(data, length, &lineIndex, false, newCardObject);
+}
 
-  if (json[jsonIndex - 1] == ',')
-    jsonIndex--;
+VCardErrorCode openCardStream(const char* fileName, CardStream** stream)
+{
+  VCardErrorCode parseStatus;
+  CardStream *newStream;
+
+  if (stream == NULL)
+    return OTHER_ERROR;
+  *stream = NULL;
 
-  json[jsonIndex] = ']';
-  json[jsonIndex+1] = '\0';
+  if ((newStream = malloc(sizeof(CardStream))) == NULL)
+    return OTHER_ERROR;
 
+  if ((parseStatus = mapVCardFile(fileName, &newStream->file)) != OK)
+  {
+    free(newStream);
+    return parseStatus;
+  }
+  newStream->lineIndex = 0;
+  newStream->useArena = false;
 
-  return json;
+  *stream = newStream;
+
+  return OK;
 }
 
-List* JSONtoStrList(const char* str)
+VCardErrorCode nextCard(CardStream* stream, Card** newCardObject)
 {
-  if (str == NULL)
-    return NULL;
+  VCardErrorCode parseStatus;
+  size_t cardStart;
 
-  List *strList = initializeList(printString ,deleteString,compareString);
+  if (newCardObject == NULL)
+    return OTHER_ERROR;
+  *newCardObject = NULL;
 
-  char *tempStr = NULL;
-  int jsonIndex = 0;
+  if (stream == NULL)
+    return OTHER_ERROR;
 
-  if (str[jsonIndex] != '[' || str[jsonIndex+1]!= '\"')//make sure proper opening
-  {
-    freeList(strList);
-    return NULL;
-  }
-  jsonIndex++;
+  //blank lines between or after cards aren't part of any card
+  stream->lineIndex = skipBlankLines(stream->file.data, stream->file.length, stream->lineIndex);
 
+  if (stream->lineIndex >= stream->file.length)//no cards left
+    return OK;
 
-  bool inValue = false;
-  int allocdMem = 100;
-  int copyIndex = 0;
+  cardStart = stream->lineIndex;
 
-  while(jsonIndex < strlen(str) && str[jsonIndex] != ']')//parse contentLine until end or close bracket
+  if ((parseStatus = parseCard(stream->file.data, stream->file.length, &stream->lineIndex, stream->useArena, newCardObject)) != OK)
   {
-    if(inValue == false)
-    {
-      if(str[jsonIndex] == '\"')//start value string)
-      {
-        copyIndex = 0;
-        tempStr = calloc(sizeof(char),100);
-        allocdMem = 100;
-        tempStr[copyIndex] = '\0';
-        inValue = true;
-      }
-      else if(str[jsonIndex] != ',')//has to be a comma
-      {
-        free(tempStr);
-        freeList(strList);
-        return NULL;
-      }
-      else if(str[jsonIndex-1] != '\"' && str[jsonIndex+1] != '\"')
-      {
-        free(tempStr);
-        freeList(strList);
-        return NULL;
-      }
-      else{}//here to remind me that this is complete, should just step over comma this loop
-    }
-    else //(inValue == true )
-    {
-      if(str[jsonIndex] == '\"')//end of value string
-      {
-        tempStr[copyIndex] = '\0';
-        insertBack(strList, tempStr);
-        inValue = false;
-      }
-      else //read in char of value
-      {
-        if((int)(copyIndex * sizeof(char)) > (allocdMem -3)*sizeof(char))
-        {
-          tempStr = realloc(tempStr, sizeof(char)*(allocdMem + 50));
-          allocdMem += 50;
-        }
-
-        if (str[jsonIndex] == '\\')//escaped char
-        {
-          jsonIndex++;
-          if (str[jsonIndex] == 'n' || str[jsonIndex] == 'N')
-            tempStr[copyIndex] = '\n';
-          else if(str[jsonIndex] == '\"')
-            tempStr[copyIndex] = '\"';
-          else if(str[jsonIndex] == '\\')
-            tempStr[copyIndex] = '\\';
-          else//i don't know what other chars could be escaped, just put them in raw
-            tempStr[copyIndex] = str[jsonIndex];
-        }
-        else
-          tempStr[copyIndex] = str[jsonIndex];
-        copyIndex++;
-      }
-    }
-    jsonIndex++;
+    //skip the rest of the broken card so the next call starts on a BEGIN line
+    stream->lineIndex = skipBrokenCard(stream->file.data, stream->file.length, cardStart, stream->lineIndex);
   }
 
-  return strList;
+  return parseStatus;
 }
 
-char* propToJSON(const Property* prop)
+VCardErrorCode openCardStreamFromBuffer(const char* data, size_t length, CardStream** stream)
 {
-  char *json = calloc(sizeof(char), 100);
-  char *propValues;
-
-  if (prop == NULL)
-  {
-    strcpy(json, "\0");
-    return json;
-  }
-
-  if(prop->group == NULL)
-  {
-    strcpy(json, "\0");
-    return json;
-  }
-  strcat(json, "{\"group\":\"\0");
-  strcat(json, prop->group);
+  CardStream *newStream;
 
-  strcat(json, "\",\"name\":\"\0");
-  strcat(json, prop->name);
+  if (stream == NULL)
+    return OTHER_ERROR;
+  *stream = NULL;
 
-  strcat(json, "\",\"values\":\0");
+  if (data == NULL)
+    return INV_FILE;
 
-  propValues = strListToJSON(prop->values);
+  if ((newStream = malloc(sizeof(CardStream))) == NULL)
+    return OTHER_ERROR;
 
-  if (sizeof(char)*(strlen(propValues)+strlen(json)) > 98)
-    json = realloc(json, sizeof(char)*(strlen(propValues)+strlen(json) + 10));
+  borrowVCardBuffer(data, length, &newStream->file);
+  newStream->lineIndex = 0;
+  newStream->useArena = false;
 
-  strcat(json, propValues);
-  free(propValues);
-  strcat(json, "}\0");
+  *stream = newStream;
 
-  return json;
+  return OK;
 }
 
-Property* JSONtoProp(const char* str)
+VCardErrorCode createCardsParallel(const char* fileName, int threadCount, Card*** cards, size_t* cardCount)
 {
-  if(str == NULL)
-    return NULL;
-  if (strlen(str)<5)
-    return NULL;
+  VCardBuffer vCardFile;//the whole file, mapped read-only
+  VCardErrorCode parseStatus;
 
-  Property *newProp = malloc(sizeof(Property));
-  newProp->name = NULL;
-  newProp->group = NULL;
-  newProp->parameters = initializeList(printParameter, deleteParameter, compareParameters);
-  newProp->values = initializeList(printString, deleteString, compareString);
+  if (cards == NULL || cardCount == NULL)
+    return OTHER_ERROR;
+  *cards = NULL;
+  *cardCount = 0;
 
-  int strIndex = 0;
-  int copyIndex = 0;
-  int memAllocd = 0;
-  int length = strlen(str) - 1;
+  if ((parseStatus = mapVCardFile(fileName, &vCardFile)) != OK)
+    return parseStatus;
 
-  while (str[strIndex] != ':' && strIndex != length - 1)
-    strIndex++;
+  parseStatus = parseCardsParallel(vCardFile.data, vCardFile.length, threadCount, cards, cardCount);
 
-  strIndex++;
-  if (strIndex == length -1 || str[strIndex] != '\"')
-  {
-    deleteProperty(newProp);
-    return NULL;
-  }
+  unmapVCardFile(&vCardFile);
 
-  strIndex++;
-  //group name
-  if (str[strIndex] == '\"')//empty group name
-  {
-    newProp->group = calloc(sizeof(char), 2);//lets be safe give it two;
-    strcpy(newProp->group, "\0");
-  }
-  else//copy in group value
-  {
-    newProp->group = calloc(sizeof(char),50);//allocate memory for group name
-    memAllocd = 50;
-    while (strIndex != length -1 && str[strIndex] != '\"')
-    {
-      if (copyIndex*sizeof(char)>= (memAllocd - 2)*sizeof(char))//realloc memory if needed
-      {
-        memAllocd += 50;
-        newProp->group = realloc(newProp->group, memAllocd*sizeof(char));
-      }
-      newProp->group[copyIndex] = str[strIndex];
-      strIndex++;
-      copyIndex++;
-    }
-    newProp->group[copyIndex] = '\0';
-    copyIndex = 0;
-    memAllocd = 0;
+  return parseStatus;
+}
 
-    if (strIndex != length -1)
-    {
-      deleteProperty(newProp);
-      return NULL;
-    }
-  }
+void deleteCards(Card** cards, size_t cardCount)
+{
+  size_t i;
 
-  while (str[strIndex] != ':')//jump to property name
-  {
-    if(strIndex == length - 1)
-    {
-      deleteProperty(newProp);
-      return NULL;
-    }
-    strIndex++;
-  }
-  strIndex++;//jump over colon
-  if (strIndex == length -1 || str[strIndex] != '\"')
-  {
-    deleteProperty(newProp);
-    return NULL;
-  }
+  if (cards == NULL)
+    return;
 
-  strIndex++;
-  if (str[strIndex] == '\"')//name can't be empty
-  {
-    deleteProperty(newProp);
-    return NULL;
-  }
-  else//copy in name value
-  {
-    newProp->name = calloc(sizeof(char),40);//allocate memory for property name
-    memAllocd = 40;
+  for (i = 0; i < cardCount; i++)
+    deleteCard(cards[i]);
 
-    while (strIndex != length -1 && str[strIndex] != '\"')
-    {
-      if (copyIndex*sizeof(char) >= (memAllocd - 2)*sizeof(char))//realloc memory if needed
-      {
-        memAllocd += 50;
-        newProp->name = realloc(newProp->name, memAllocd*sizeof(char));
-      }
-      newProp->name[copyIndex] = str[strIndex];
-      strIndex++;
-      copyIndex++;
-    }
-    newProp->name[copyIndex] = '\0';
-    copyIndex = 0;
-    memAllocd = 0;
+  free(cards);
+}
 
-    if (strIndex == length -1)
-    {
-      deleteProperty(newProp);
-      return NULL;
-    }
-  }
+void setCardStreamArena(CardStream* stream, bool useArena)
+{
+  if (stream != NULL)
+    stream->useArena = useArena;
+}
 
+void closeCardStream(CardStream* stream)
+{
+  if (stream == NULL)
+    return;
 
-  while (str[strIndex] != ':')//jump to property values
-  {
-    if(strIndex == length - 1)
-    {
-      deleteProperty(newProp);
-      return NULL;
-    }
-    strIndex++;
-  }
-  strIndex++;//jump over colon
+  unmapVCardFile(&stream->file);
+  free(stream);
+}
 
-  newProp->values = JSONtoStrList(&str[strIndex]);
+char* strListToJSON(const List* strList)
+{
+  OutBuffer out;
+
+  if (strList == NULL)
+    return NULL;
 
-  if(newProp->values == NULL)
+  if (!startOutBuffer(&out, 128))
+    return NULL;
+
+  if (!appendJSONStrList(&out, strList))
   {
-    deleteProperty(newProp);
+    freeOutBuffer(&out);
     return NULL;
   }
 
-  return newProp;
+  return finishJSON(&out);
 }
 
-char* dtToJSON(const DateTime* prop)
+List* JSONtoStrList(const char* str)
 {
-  char *json;
+  JSONReader reader;
+  JSONToken first;
+  List *strList;
 
-  if (prop == NULL)
-  {
-    json = calloc(sizeof(char), 2);
-    strcpy(json, "");
-    return json;
-  }
-  else
-  {
-    json = calloc(sizeof(char), 150);
-  }
-  int memAllocd = 150;
+  if (str == NULL)
+    return NULL;
 
-  strcpy(json, "{\"isText\":\0");
+  if ((strList = initializeList(printString, deleteString, compareString)) == NULL)
+    return NULL;
 
-  if (prop->isText == true)
-  {
-    strcat(json, "true,\"date\":\"\",\"time\":\"\",\"text\":\"\0");
-    if( sizeof(char)*(strlen(json) + strlen(prop->text)) > memAllocd*sizeof(char))
-    {
-      memAllocd = 20 + strlen(json) + strlen(prop->text);
-      json = realloc(json, sizeof(char)*(20 + strlen(json) + strlen(prop->text)));
-    }
-    strcat(json, prop->text);
-    strcat(json, "\",\"isUTC\":false}");
+  startJSONReader(&reader, str, strlen(str));
 
-  }
-  else
+  if (!nextJSONToken(&reader, &first) || !readJSONStrList(&reader, &first, strList) || !atJSONEnd(&reader))
   {
-    strcat(json, "false,\"date\":\"");
-
-    if(sizeof(char)*(strlen(json) + strlen(prop->date)) >= memAllocd*sizeof(char))//make sure there's mem for date
-    {
-      memAllocd = (int)(40 + strlen(json) + strlen(prop->date));
-      json = realloc(json, sizeof(char)*(40 + strlen(json) + strlen(prop->date)));
-    }
-    strcat(json, prop->date);
-    strcat(json, "\",\"time\":\"");
+    freeList(strList);
+    return NULL;
+  }
 
-    if(sizeof(char)*(strlen(json) + strlen(prop->time)) >= memAllocd*sizeof(char))//make sure there's mem for time
-    {
-      memAllocd = (int)(40 + strlen(json) + strlen(prop->time));
-      json = realloc(json, sizeof(char)*(40 + strlen(json) + strlen(prop->time)));
-    }
+  return strList;
+}
 
-    strcat(json, prop->time);
-    strcat(json, "\",\"text\":\"\",\"isUTC\":");
+char* propToJSON(const Property* prop)
+{
+  OutBuffer out;
 
-    if(sizeof(char)*(strlen(json) + 20) >= memAllocd*sizeof(char))//make sure theres mem for UTC
-    {
-      memAllocd = (int)(40 + strlen(json) + strlen(prop->date));
-      json = realloc(json, sizeof(char)*(40 + memAllocd));
-    }
+  if (!startOutBuffer(&out, 128))
+    return NULL;
 
-    if (prop->UTC == true)
-      strcat(json, "true}");
-    else
-      strcat(json, "false}");
+  if (prop != NULL && prop->group != NULL && !appendJSONProperty(&out, prop, false))//no property gives ""
+  {
+    freeOutBuffer(&out);
+    return NULL;
   }
 
-
-  return json;
+  return finishJSON(&out);
 }
 
-DateTime* JSONtoDT(const char* str)
+char* cardToJSON(const Card* obj)
 {
-  if (str == NULL)
-    return NULL;
-
-  int sourceIndex= 0;
-  int copyIndex = 0;
-  int length = strlen(str) - 1;
-  char *booleanCheck;
-  DateTime *newDt = calloc(sizeof(DateTime), 1);
+  OutBuffer out;
 
-  while (str[sourceIndex] != ':' && sourceIndex != length)
-  {
-    sourceIndex++;
-  }
+  if (!startOutBuffer(&out, 4096))
+    return NULL;
 
-  if (sourceIndex > length - 3)//invalid format, should be more in string
+  if (obj != NULL && !appendJSONCard(&out, obj))//no card gives ""
   {
-    free(newDt);
+    freeOutBuffer(&out);
     return NULL;
   }
-  sourceIndex++;//step over colon
 
+  return finishJSON(&out);
+}
 
-  booleanCheck = calloc(sizeof(char), 10);
+VCardErrorCode exportNDJSON(const char* fileName, int fd)
+{
+  VCardErrorCode parseStatus;
+  CardStream *stream;
 
-  while (str[sourceIndex] != ',')//copy isText Boolean
-  {
-    booleanCheck[copyIndex] = str[sourceIndex];
-    sourceIndex++;
-    copyIndex++;
+  if (fd < 0)
+    return WRITE_ERROR;
 
-    if (sourceIndex == length || sourceIndex == length -1)
-    {
-      free(newDt);
-      return NULL;
-    }
-  }
+  if ((parseStatus = openCardStream(fileName, &stream)) != OK)
+    return parseStatus;
 
-  if (strcmpIC(booleanCheck, "true")==0)
-  {
-    newDt->isText = true;
-  }
-  else if (strcmpIC(booleanCheck, "false")==0)
-  {
-    newDt->isText = false;
-  }
-  else
-  {
-    free(newDt);
-    free(booleanCheck);
-    return NULL;
-  }
-  free(booleanCheck);
+  setCardStreamArena(stream, true);//each card is thrown away as soon as it is written
+  parseStatus = writeNDJSON(fd, stream);
+  closeCardStream(stream);
 
-  while (str[sourceIndex] != ':')//go to date value
-  {
-    sourceIndex++;
-    if(sourceIndex == length -2)
-    {
-      free(newDt);
-      return NULL;
-    }
-  }
-  sourceIndex++;//step over colon
-  sourceIndex++;//step over parenthesis
+  return parseStatus;
+}
 
-  copyIndex = 0;
-  while (str[sourceIndex] != '\"' && copyIndex < 8)//copy in date value
-  {
-    newDt->date[copyIndex] = str[sourceIndex];
-    copyIndex++;
-    sourceIndex++;
+Property* JSONtoProp(const char* str)
+{
+  JSONReader reader;
+  JSONToken first;
+  Property *newProp;
 
-    if (sourceIndex == length || sourceIndex == length -1)
-    {
-      free(newDt);
-      return NULL;
-    }
-  }
-  newDt->date[copyIndex] = '\0';
+  if (str == NULL)
+    return NULL;
 
-  if (str[sourceIndex] != '\"')//date was too long
-  {
-    free(newDt);
+  startJSONReader(&reader, str, strlen(str));
+
+  if (!nextJSONToken(&reader, &first) || !readJSONProperty(&reader, &first, &newProp))
     return NULL;
-  }
 
-  while (str[sourceIndex] != ':')//go to time value
+  if (!atJSONEnd(&reader))
   {
-    sourceIndex++;
-    if (sourceIndex == length || sourceIndex == length -1)//make sure not end of string
-    {
-      free(newDt);
-      return NULL;
-    }
+    deleteProperty(newProp);
+    return NULL;
   }
-  sourceIndex++;//step over colon
-  sourceIndex++;//step over parenthesis
 
+  return newProp;
+}
 
-  copyIndex = 0;
-  while (str[sourceIndex] != '"' && copyIndex < 6)//copy time string
-  {
-    newDt->time[copyIndex] = str[sourceIndex];
-    copyIndex++;
-    sourceIndex++;
-
-    if (sourceIndex == length -1)
-    {
-      free(newDt);
-      return NULL;
-    }
-  }
-  newDt->time[copyIndex] = '\0';//null terminate time
+char* dtToJSON(const DateTime* prop)
+{
+  OutBuffer out;
 
+  if (!startOutBuffer(&out, 128))
+    return NULL;
 
-  while (str[sourceIndex] != ':')//go to text value
+  if (prop != NULL && !appendJSONDateTime(&out, prop))//no date gives ""
   {
-    sourceIndex++;
-    if (sourceIndex == length -3)//make sure not end of string
-    {
-      free(newDt);
-      return NULL;
-    }
+    freeOutBuffer(&out);
+    return NULL;
   }
-  sourceIndex++;//step over colon
-  sourceIndex++;//step over parenthesis
 
-  copyIndex = 0;
-  char *tempDate = calloc(sizeof(char),200);
-  int mem = 200;
-  while (str[sourceIndex] != '\"')//copy entire text value
-  {
-    tempDate[copyIndex] = str[sourceIndex];
-    sourceIndex++;
-    copyIndex++;
-    if (sourceIndex == length -2)//make sure not end of string
-    {
-      free(newDt);
-      return NULL;
-    }
-    if (sourceIndex > mem - 10)
-    {
-      mem += 100;
-      tempDate = realloc(tempDate, sizeof(char)*(mem+copyIndex));
-    }
-  }
-  tempDate[copyIndex] = '\0';
+  return finishJSON(&out);
+}
 
-  newDt = realloc(newDt, sizeof(DateTime) + sizeof(char)*(strlen(tempDate) + 2));
-  strcpy(newDt->text, tempDate);
-  free(tempDate);
+DateTime* JSONtoDT(const char* str)
+{
+  JSONReader reader;
+  JSONToken first;
+  DateTime *newDate;
 
-  while (str[sourceIndex] != ':')//go to is text boolean
-  {
-    sourceIndex++;
-    if (sourceIndex == length -1)//make sure not end of string
-    {
-      free(newDt);
-      return NULL;
-    }
-  }
-  sourceIndex++;//step over colon
+  if (str == NULL)
+    return NULL;
 
-  booleanCheck = calloc(sizeof(char),20);
-  copyIndex = 0;
+  startJSONReader(&reader, str, strlen(str));
 
-  while (str[sourceIndex] != '}' && sourceIndex != length)//copy isText Boolean
-  {
-    booleanCheck[copyIndex] = str[sourceIndex];
-    sourceIndex++;
-    copyIndex++;
-  }
+  if (!nextJSONToken(&reader, &first) || !readJSONDateTime(&reader, &first, &newDate))
+    return NULL;
 
-  if (strcmpIC(booleanCheck, "true")==0)
-    newDt->UTC = true;
-  else if (strcmp(booleanCheck, "false")==0)
-    newDt->UTC = false;
-  else
+  if (!atJSONEnd(&reader))
   {
-    free(newDt);
-    free(booleanCheck);
+    deleteDate(newDate);
     return NULL;
   }
-  free(booleanCheck);
 
-  return newDt;
+  return newDate;
 }
 
 Card* JSONtoCard(const char* str)
 {
+  JSONReader reader;
+  JSONToken first;
+  Card *newCard;
+
   if (str == NULL)
     return NULL;
 
-  int sourceIndex = 0;
-  int copyIndex;
-  int length = strlen(str) - 1;
-  char *name = calloc(sizeof(char),20);
-  char *value;
-  char *group = malloc(sizeof(char));
+  startJSONReader(&reader, str, strlen(str));
 
-  Card *newCard = initializeCard(printProperty, deleteProperty, compareProperties);
+  if (!nextJSONToken(&reader, &first) || !readJSONFN(&reader, &first, &newCard))
+    return NULL;
 
-  while(str[sourceIndex] != '\"')
+  if (!atJSONEnd(&reader))
   {
-    sourceIndex++;
-
-    if (sourceIndex == length-1)
-    {
-      free(name);
-      free(group);
-      deleteCard(newCard);
-      return NULL;
-    }
+    deleteCard(newCard);
+    return NULL;
   }
-  sourceIndex++;//step over parenthesis
 
+  return newCard;
+}
 
-  copyIndex = 0;
-  while(str[sourceIndex] != '\"')//copy in name
-  {
-    name[copyIndex] = str[sourceIndex];
-    copyIndex++;
-    sourceIndex++;
+Card* JSONtoFullCard(const char* str)
+{
+  JSONReader reader;
+  JSONToken first;
+  Card *newCard;
 
-    if (sourceIndex == length)
-    {
-      free(name);
-      free(group);
-      deleteCard(newCard);
-      return NULL;
-    }
-  }
-  name[copyIndex] = '\0';
-  sourceIndex++;
-  sourceIndex++;
-  sourceIndex++;
+  if (str == NULL)
+    return NULL;
+
+  startJSONReader(&reader, str, strlen(str));
 
+  if (!nextJSONToken(&reader, &first) || !readJSONCard(&reader, &first, &newCard))
+    return NULL;
 
-  value = calloc(sizeof(char), strlen(&str[sourceIndex])+1);
-  copyIndex = 0;
-  while (str[sourceIndex] != '\"')
+  if (!atJSONEnd(&reader))
   {
-    value[copyIndex] = str[sourceIndex];
-    sourceIndex++;
-    copyIndex++;
-    if (sourceIndex == length)
-    {
-      free(value);
-      free(name);
-      free(group);
-      deleteCard(newCard);
-      return NULL;
-    }
+    deleteCard(newCard);
+    return NULL;
   }
-  value[copyIndex] = '\0';
-
-  Property *fn = createProperty();
-
-  group[0] = '\0';
-
-  fn->group = group;
-  fn->name = name;
-  insertBack(fn->values, value);
-  newCard->fn = fn;
 
   return newCard;
 }
@@ -1045,7 +580,20 @@ void addProperty(Card* card, const Property* toBeAdded)
   if (card->optionalProperties == NULL)
     return;
 
-  insertBack(card->optionalProperties, (void*)toBeAdded);
+  CardArena *arena = cardArena(card);
+
+  if (arena != NULL && !arenaAdopt(arena, (void*)toBeAdded, deleteProperty))//arena card frees it on delete
+    return;
+
+  appendProperty(card, (Property*)toBeAdded);
+}
+
+void resetCardValidation(Card* obj)
+{
+  CardRecord *record = cardRecord(obj);
+
+  if (record != NULL)
+    countProperties(&record->validation, obj->optionalProperties);
 }
 
 /*
@@ -1056,6 +604,14 @@ void deleteCard(Card* obj)
   if (obj == NULL)
     return;
 
+  CardArena *arena = cardArena(obj);
+
+  if (arena != NULL)//the card itself is in the arena too
+  {
+    freeArena(arena);
+    return;
+  }
+
   if (obj->fn != NULL)
     deleteProperty(obj->fn);
 
@@ -1156,11 +712,8 @@ void deleteProperty(void* toBeDeleted)
 
   if (deleteProp != NULL)
   {
-    if (deleteProp->name != NULL)
-      free(deleteProp->name);
-
-    if (deleteProp->group != NULL)
-      free(deleteProp->group);
+    freeName(deleteProp->name);//interned names are shared, freeName leaves them be
+    freeName(deleteProp->group);
 
     if (deleteProp->parameters != NULL)
       freeList(deleteProp->parameters);
@@ -1172,9 +725,56 @@ void deleteProperty(void* toBeDeleted)
   }
 }
 
+/*
+* compareLists
+*
+* element by element with compare, a list that runs out first is the smaller one. Nothing
+* is allocated
+*/
+static int compareLists(List* one, List* two, int (*compare)(const void* first,const void* second))
+{
+  ListIterator oneIter = createIterator(one), twoIter = createIterator(two);
+  void *oneData, *twoData;
+  int result;
+
+  while (true)
+  {
+    oneData = nextElement(&oneIter);
+    twoData = nextElement(&twoIter);
+
+    if (oneData == NULL || twoData == NULL)
+      return (oneData != NULL) - (twoData != NULL);
+
+    if ((result = compare(oneData, twoData)) != 0)
+      return result;
+  }
+}
+
 /*
 * compareProperties
+*
+* group, then name, then parameters, then values, compared in place
+*/
+/*
+* compareParametersExact
+*
+* name then value, case and all, the way properties always compared their parameters.
+* compareParameters on its own ignores case
 */
+static int compareParametersExact(const void* first,const void* second)
+{
+  const Parameter *oneP = (const Parameter*)first, *twoP = (const Parameter*)second;
+  int result;
+
+  if (oneP == NULL || twoP == NULL)
+    return compareParameters(first, second);
+
+  if (oneP->name != twoP->name && (result = strcmp(oneP->name, twoP->name)) != 0)
+    return result;
+
+  return strcmp(oneP->value, twoP->value);
+}
+
 int compareProperties(const void* first,const void* second)
 {
   if (first == NULL && second == NULL)
@@ -1185,21 +785,21 @@ int compareProperties(const void* first,const void* second)
     return 1;
 
   int result;//int value to be returned
-  char *oneStr, *twoStr;//holders for string property values
-  Property *oneProp, *twoProp;//holders for property objects
+  const Property *oneProp, *twoProp;//holders for property objects
 
-  oneProp = (Property*)first;
-  twoProp = (Property*)second;
+  oneProp = (const Property*)first;
+  twoProp = (const Property*)second;
 
-  oneStr = printProperty(oneProp);
-  twoStr = printProperty(twoProp);
+  if ((result = strcmp(oneProp->group, twoProp->group)) != 0)
+    return result;
 
-  result = strcmp(oneStr, twoStr);
+  if (oneProp->name != twoProp->name && (result = strcmp(oneProp->name, twoProp->name)) != 0)//interned names are often the same pointer
+    return result;
 
-  free(oneStr);
-  free(twoStr);
+  if ((result = compareLists(oneProp->parameters, twoProp->parameters, compareParametersExact)) != 0)
+    return result;
 
-  return result;
+  return compareLists(oneProp->values, twoProp->values, compareValues);
 }
 
 /*
@@ -1276,6 +876,7 @@ void deleteParameter(void* toBeDeleted)
   Parameter *deleteParam;
   deleteParam = (Parameter*)toBeDeleted;
 
+  freeName(deleteParam->name);
   free(deleteParam);
 }
 int compareParameters(const void* first,const void* second)
@@ -1288,28 +889,16 @@ int compareParameters(const void* first,const void* second)
     return 1;
 
   int result;
-  char *oneS, *twoS;
-  Parameter *oneP, *twoP;
-
-  oneP = (Parameter*)first;
-  twoP = (Parameter*)second;
-
-  oneS = malloc(strlen(oneP->name)+ strlen(oneP->value) + 1);
-  strcpy(oneS, oneP->name);
-  strcat(oneS, oneP->value);
-  oneS[strlen(oneP->name)+ strlen(oneP->value)] = '\0';
+  const Parameter *oneP, *twoP;
 
-  twoS = malloc(strlen(twoP->name)+ strlen(twoP->value) + 1);
-  strcpy(twoS, twoP->name);
-  strcat(twoS, twoP->value);
-  twoS[strlen(twoP->name)+ strlen(twoP->value)] = '\0';
+  oneP = (const Parameter*)first;
+  twoP = (const Parameter*)second;
 
-  result = strcmpIC(oneS, twoS);
+  //name then value, both ignoring case
+  if (oneP->name != twoP->name && (result = strcmpIC(oneP->name, twoP->name)) != 0)
+    return result;
 
-  free(oneS);
-  free(twoS);
-
-  return result;
+  return strcmpIC(oneP->value, twoP->value);
 }
 char* printParameter(void* toBePrinted)
 {
@@ -1384,7 +973,33 @@ void deleteDate(void* toBeDeleted)
 }
 int compareDates(const void* first,const void* second)
 {
-  return 1;
+  if (first == NULL && second == NULL)
+    return 0;
+  else if (first == NULL)
+    return -1;
+  else if (second == NULL)
+    return 1;
+
+  int result;
+  const DateTime *oneDate, *twoDate;
+
+  oneDate = (const DateTime*)first;
+  twoDate = (const DateTime*)second;
+
+  if (oneDate->isText != twoDate->isText)//dates before text
+    return oneDate->isText ? 1 : -1;
+
+  if (oneDate->isText)
+    return strcmp(oneDate->text, twoDate->text);
+
+  //YYYYMMDD and HHMMSS sort in time order as plain strings
+  if ((result = strcmp(oneDate->date, twoDate->date)) != 0)
+    return result;
+
+  if ((result = strcmp(oneDate->time, twoDate->time)) != 0)
+    return result;
+
+  return (int)oneDate->UTC - (int)twoDate->UTC;
 }
 char* printDate(void* toBePrinted)
 {
@@ -2,61 +2,288 @@
  * @file ValidationHelper.c
  * @author Kevin ioi
  * @date Oct 2018
- * @brief
+ * @brief File containing the rules a card is validated against, and the validate-only
+ *        mode that checks a vcf file against them without building a Card
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include "VCardParser.h"
 #include "ValidationHelper.h"
 #include "LinkedListAPI.h"
 #include "ParseHelper.h"
+#include "ArenaHelper.h"
+#include "CardHelper.h"
+#include "DateHelper.h"
+#include "ScanHelper.h"
+
+//propertyID() hashes a name in to one of these slots. The seed was searched for so that
+//every RFC 6350 property lands in a slot of its own, any other name is checked against
+//whatever happens to be in its slot and comes back UNKNOWN_PROPERTY.
+//A new property needs a new seed and slot numbers, not just a new row
+#define PROPERTY_SEED 18316u
+#define PROPERTY_SLOT_BITS 6
+#define PROPERTY_MAX_LENGTH 12 //CLIENTPIDMAP
+
+typedef struct propertySlot {
+  const char *name;
+  pValue id;
+} PropertySlot;
+
+static const PropertySlot propertySlots[1 << PROPERTY_SLOT_BITS] = {
+  [3] = {"TEL", TEL},
+  [4] = {"ORG", ORG},
+  [5] = {"EMAIL", EMAIL},
+  [8] = {"BDAY", BDAY},
+  [9] = {"PRODID", PRODID},
+  [11] = {"TZ", TZ},
+  [13] = {"TITLE", TITLE},
+  [14] = {"XML", XML},
+  [16] = {"FN", FN},
+  [17] = {"GENDER", GENDER},
+  [20] = {"ADR", ADR},
+  [22] = {"URL", URL},
+  [23] = {"PHOTO", PHOTO},
+  [25] = {"CALURI", CALURI},
+  [27] = {"UID", UID},
+  [28] = {"KIND", KIND},
+  [32] = {"GEO", GEO},
+  [33] = {"CATEGORIES", CATEGORIES},
+  [35] = {"RELATED", RELATED},
+  [36] = {"REV", REV},
+  [37] = {"ANNIVERSARY", ANNIVERSARY},
+  [38] = {"LOGO", LOGO},
+  [39] = {"LANG", LANG},
+  [40] = {"SOUND", SOUND},
+  [42] = {"VERSION", VERSION},
+  [44] = {"MEMBER", MEMBER},
+  [46] = {"KEY", KEY},
+  [48] = {"NOTE", NOTE},
+  [49] = {"NICKNAME", NICKNAME},
+  [50] = {"CLIENTPIDMAP", CLIENTPIDMAP},
+  [51] = {"SOURCE", SOURCE},
+  [52] = {"FBURL", FBURL},
+  [53] = {"ROLE", ROLE},
+  [55] = {"CALADRURI", CALADRURI},
+  [56] = {"N", N},
+  [57] = {"IMPP", IMPP},
+};
 
-VCardErrorCode validateProp(const Property *prop, List *pList)
+/**
+* propertyID()
+*
+* which RFC 6350 property the first length chars of name are, ignoring case. One hash and
+* one compare, no copies. UNKNOWN_PROPERTY for anything else (X- names, BEGIN, END)
+**/
+pValue propertyID(const char *name, size_t length)
 {
-  pNode *pCountNode;
+  const PropertySlot *slot;
+  uint32_t hash = PROPERTY_SEED;
+  size_t i;
+
+  if (name == NULL || length == 0 || length > PROPERTY_MAX_LENGTH)
+    return UNKNOWN_PROPERTY;
+
+  for (i = 0; i < length; i++)//FNV-1a, |0x20 folds the case of letters
+  {
+    hash ^= (unsigned char)(name[i] | 0x20);
+    hash *= 16777619u;
+  }
+
+  slot = &propertySlots[hash >> (32 - PROPERTY_SLOT_BITS)];
+
+  if (slot->name != NULL && strlen(slot->name) == length && strncmpIC(name, slot->name, length) == 0)
+    return slot->id;
 
+  return UNKNOWN_PROPERTY;
+}
+
+/*
+  What RFC 6350 allows of each property, when it shows up in optionalProperties
+*/
+typedef struct propertyRule {
+  unsigned char maxCount;//most times it may appear in one card, 0 for no limit
+  unsigned char valueCount;//exact number of values it must have, 0 for any
+  bool multiValued;//may have more than one value
+  bool optional;//may be in optionalProperties at all
+} PropertyRule;
+
+static const PropertyRule propertyRules[UNKNOWN_PROPERTY] = {
+  [SOURCE]       = {0, 0, false, true},
+  [KIND]         = {1, 0, false, true},
+  [XML]          = {0, 0, false, true},
+  [FN]           = {0, 0, false, true},
+  [N]            = {1, 5, true,  true},
+  [NICKNAME]     = {0, 0, true,  true},
+  [PHOTO]        = {0, 0, true,  true},
+  [BDAY]         = {0, 0, false, true},
+  [ANNIVERSARY]  = {0, 0, false, true},
+  [GENDER]       = {1, 0, true,  true},
+  [ADR]          = {0, 7, true,  true},
+  [TEL]          = {0, 0, true,  true},
+  [EMAIL]        = {0, 0, false, true},
+  [IMPP]         = {0, 0, false, true},
+  [LANG]         = {0, 0, false, true},
+  [TZ]           = {0, 0, false, true},
+  [GEO]          = {0, 0, false, true},
+  [TITLE]        = {0, 0, false, true},
+  [ROLE]         = {0, 0, false, true},
+  [LOGO]         = {0, 0, false, true},
+  [ORG]          = {0, 0, true,  true},
+  [MEMBER]       = {0, 0, false, true},
+  [RELATED]      = {0, 0, false, true},
+  [CATEGORIES]   = {0, 0, true,  true},
+  [NOTE]         = {0, 0, false, true},
+  [PRODID]       = {1, 0, false, true},
+  [REV]          = {1, 0, false, true},
+  [SOUND]        = {0, 0, false, true},
+  [UID]          = {1, 0, false, true},
+  [CLIENTPIDMAP] = {0, 0, true,  true},
+  [URL]          = {0, 0, false, true},
+  [VERSION]      = {0, 0, false, false},//only ever the second line of the card
+  [KEY]          = {0, 0, false, true},
+  [FBURL]        = {0, 0, false, true},
+  [CALADRURI]    = {0, 0, false, true},
+  [CALURI]       = {0, 0, false, true},
+};
+
+VCardErrorCode validateProp(const Property *prop, int *propertyCounts)
+{
   if (prop == NULL)
     return INV_PROP;
 
   if (prop->group == NULL || prop->parameters == NULL|| prop->values == NULL || prop->name == NULL)
     return INV_PROP;
 
-  if ((pCountNode = (pNode*)findElement(pList, nodeNameCmp, prop->name)) == NULL)//check if valid prop name
+  return checkPropertyRules(propertyID(prop->name, strlen(prop->name)), getLength(prop->values), propertyCounts);
+}
+
+/**
+* checkPropertyRules()
+*
+* the propertyRules checks of validateProp, for a property known only by its ID and how
+* many values it has
+**/
+VCardErrorCode checkPropertyRules(pValue id, int valueCount, int *propertyCounts)
+{
+  const PropertyRule *rule;
+
+  if (id == UNKNOWN_PROPERTY)//check if valid prop name
     return INV_PROP;//invalid Property name
 
-  pCountNode->count++;//increment count of property type
+  rule = &propertyRules[id];
+  propertyCounts[id]++;//increment count of property type
 
-  if (strcmpIC(prop->name, "N")==0 && getLength(prop->values) != 5)//make sure N has 5 values
+  if (rule->valueCount != 0 && valueCount != rule->valueCount)//N and ADR have a fixed number of values
     return INV_PROP;
 
-  if (strcmpIC(prop->name, "ADR")==0 && getLength(prop->values) != 7)//make sure ADR has 7 values
+  if (!rule->optional)//should have a version in optionalProperties
+    return INV_CARD;
+
+  if (rule->maxCount != 0 && propertyCounts[id] > rule->maxCount)//too many of a property that should only exist once
+    return INV_PROP;
+
+  if (valueCount<1)//the property mut have a value
     return INV_PROP;
 
-  if (strcmpIC(prop->name, "VERSION")==0)//should have a version in optionalProperties
+  if (valueCount>1 && !rule->multiValued)//only some properties may have multiple values
+    return INV_PROP;
+
+  return OK;
+}
+
+/**
+* checkProperty()
+*
+* validateProp one more property in to validation, unless an earlier one already failed
+**/
+static void checkProperty(CardValidation *validation, const Property *prop)
+{
+  if (validation->status != OK)//only the first error is reported
+    return;
+
+  validation->status = validateProp(prop, validation->propertyCounts);
+
+  if (validation->status == OK && propertyID(prop->name, strlen(prop->name)) == KIND &&
+      strcmpIC((char*)getFromFront(prop->values), "group") == 0)
+    validation->kindIsGroup = true;
+}
+
+/**
+* countProperties()
+*
+* start validation over and check every property in properties
+**/
+void countProperties(CardValidation *validation, const List *properties)
+{
+  ListIterator itr = createIterator((List*)properties);
+  Property *tempProp;
+
+  memset(validation->propertyCounts, 0, sizeof(validation->propertyCounts));
+  validation->status = OK;
+  validation->kindIsGroup = false;
+
+  while (validation->status == OK && (tempProp = (Property*)nextElement(&itr)) != NULL)
+    checkProperty(validation, tempProp);
+
+  validation->changes = properties->changes;
+}
+
+/**
+* validateProperties()
+*
+* validateProp over all of card's optionalProperties, then the MEMBER rule. A card from
+* initializeCard keeps what was found up to date as properties are appended, so this only
+* walks the list if it was edited some other way, or the card was put together by hand.
+* The card is never written to, so it walks it every time until appendProperty or
+* resetCardValidation catches up
+**/
+VCardErrorCode validateProperties(const Card *card)
+{
+  CardRecord *record = cardRecord(card);
+  CardValidation scratch;
+  const CardValidation *validation;
+
+  if (record != NULL && record->validation.changes == card->optionalProperties->changes)
   {
-    return INV_CARD;
+    validation = &record->validation;
   }
-
-  //check if there are multiple of a property, which should only exist once in a vCard
-  if (strcmpIC(prop->name, "KIND")==0 || strcmpIC(prop->name, "N")==0|| strcmpIC(prop->name, "GENDER")==0|| strcmpIC(prop->name, "PRODID")==0|| strcmpIC(prop->name, "REV")==0|| strcmpIC(prop->name, "UID")==0)
+  else
   {
-    if (pCountNode->count > 1)
-      return INV_PROP;
+    countProperties(&scratch, card->optionalProperties);
+    validation = &scratch;
   }
 
-  if (getLength(prop->values)<1)//the property mut have a value
-    return INV_PROP;
+  if (validation->status == OK && validation->propertyCounts[MEMBER] > 0 && !validation->kindIsGroup)
+    return INV_CARD;//MEMBER exists, KIND property MUST be group
+
+  return validation->status;
+}
 
-  //make sure that all properties with multiple values are supposed to have multiple values
-  if (getLength(prop->values)>1)
+/**
+* appendProperty()
+*
+* put prop on the end of card's optionalProperties and bring what the card knows about
+* them up to date, by checking just prop unless the list was edited some other way since
+**/
+void appendProperty(Card *card, Property *prop)
+{
+  CardRecord *record = cardRecord(card);
+  unsigned long changesBefore = card->optionalProperties->changes;
+
+  insertBack(card->optionalProperties, prop);
+
+  if (record == NULL)
+    return;
+
+  if (record->validation.changes != changesBefore)
   {
-    if (!(strcmpIC(prop->name, "N")==0 || strcmpIC(prop->name, "NICKNAME")==0|| strcmpIC(prop->name, "PHOTO")==0|| strcmpIC(prop->name, "GENDER")==0|| strcmpIC(prop->name, "ADR")==0|| strcmpIC(prop->name, "TEL")==0|| strcmpIC(prop->name, "ORG")==0||
-        strcmpIC(prop->name, "CATEGORIES")==0|| strcmpIC(prop->name, "CLIENTPIDMAP")==0))
-    {
-      return INV_PROP;
-    }
+    countProperties(&record->validation, card->optionalProperties);
+    return;
   }
 
-  return OK;
+  checkProperty(&record->validation, prop);
+  record->validation.changes = card->optionalProperties->changes;
 }
 
 VCardErrorCode validateParam(const Parameter *param)
@@ -74,13 +301,23 @@ VCardErrorCode validateParam(const Parameter *param)
 }
 
 VCardErrorCode validateDT(const DateTime *date)
+{
+  return validateDTFields(date, strlen(date->text));
+}
+
+/**
+* validateDTFields()
+*
+* validateDT, with the length of the text passed in so *date only needs its fixed fields
+**/
+VCardErrorCode validateDTFields(const DateTime *date, size_t textLength)
 {
   if (date->isText == true)//text format
   {
     if (date->UTC == true)
       return INV_DT;
 
-    if (strlen(date->text) == 0)
+    if (textLength == 0)
       return INV_DT;
 
     if (strlen(date->time) != 0 || strlen(date->date) != 0)
@@ -121,7 +358,7 @@ VCardErrorCode validateDT(const DateTime *date)
       }
     }
 
-    if (strlen(date->text) != 0)
+    if (textLength != 0)
       return INV_DT;
   }
   else
@@ -132,94 +369,272 @@ VCardErrorCode validateDT(const DateTime *date)
   return OK;
 }
 
-void loadPropertyCounter(List *pList)
-{
-  insertBack(pList, createPNode("ORG"));
-  insertBack(pList, createPNode("SOURCE"));
-  insertBack(pList, createPNode("KIND"));
-  insertBack(pList, createPNode("XML"));
-  insertBack(pList, createPNode("FN"));
-  insertBack(pList, createPNode("N"));
-  insertBack(pList, createPNode("NICKNAME"));
-  insertBack(pList, createPNode("PHOTO"));
-  insertBack(pList, createPNode("BDAY"));
-  insertBack(pList, createPNode("ANNIVERSARY"));
-  insertBack(pList, createPNode("GENDER"));
-  insertBack(pList, createPNode("ADR"));
-  insertBack(pList, createPNode("TEL"));
-  insertBack(pList, createPNode("EMAIL"));
-  insertBack(pList, createPNode("IMPP"));
-  insertBack(pList, createPNode("LANG"));
-  insertBack(pList, createPNode("TZ"));
-  insertBack(pList, createPNode("GEO"));
-  insertBack(pList, createPNode("TITLE"));
-  insertBack(pList, createPNode("ROLE"));
-  insertBack(pList, createPNode("LOGO"));
-  insertBack(pList, createPNode("MEMBER"));
-  insertBack(pList, createPNode("RELATED"));
-  insertBack(pList, createPNode("CATEGORIES"));
-  insertBack(pList, createPNode("NOTE"));
-  insertBack(pList, createPNode("PRODID"));
-  insertBack(pList, createPNode("REV"));
-  insertBack(pList, createPNode("SOUND"));
-  insertBack(pList, createPNode("UID"));
-  insertBack(pList, createPNode("CLIENTPIDMAP"));
-  insertBack(pList, createPNode("URL"));
-  insertBack(pList, createPNode("VERSION"));
-  insertBack(pList, createPNode("KEY"));
-  insertBack(pList, createPNode("FBURL"));
-  insertBack(pList, createPNode("CALADRURI"));
-  insertBack(pList, createPNode("CALURI"));
-}
-
-int countProperty(char *name, List *pList)
-{
-  ListIterator itr = createIterator(pList);
-  pNode *tempNode;
-
-  while ((tempNode = (pNode*)nextElement(&itr)) != NULL)//validate all property objects in optionalProperties
-  {
-    if (strcmpIC(tempNode->name, "KIND")==0)
-    {
-      return tempNode->count;
-    }
-  }
+/*
+  What validate-only mode keeps of the card it is reading, in place of the Card itself
+*/
+typedef struct cardCheck {
+  BuildStage      stage;
 
-  return 0;
+  //the first FN line is the card's fn, later ones are optional properties
+  bool            hasFn;
+  int             fnValues;
+
+  //what validateDT said about BDAY and ANNIVERSARY, if the card has them
+  bool            hasBirthday;
+  bool            hasAnniversary;
+  VCardErrorCode  birthdayStatus;
+  VCardErrorCode  anniversaryStatus;
+
+  //counts and first error of the optional properties, only its properties/changes go unused
+  CardValidation  optional;
+
+  //folded lines are unfolded in to this, it is reused for every line of the card
+  char            *unfolded;
+  size_t          unfoldedSize;
+} CardCheck;
+
+/**
+* checkDate()
+*
+* scanDate a BDAY or ANNIVERSARY line and validate what it found
+**/
+static VCardErrorCode checkDate(ContentLine *contentLine, VCardErrorCode *dateStatus)
+{
+  VCardErrorCode parseStatus;
+  DateTime fixed;
+  size_t textStart, textLength;
+
+  if ((parseStatus = scanDate(contentLine, &fixed, &textStart, &textLength)) != OK)
+    return parseStatus;
+
+  //newDate copies the text, which a null in the value would cut short
+  *dateStatus = validateDTFields(&fixed, strnlen(&(contentLine->text[textStart]), textLength));
+
+  return OK;
 }
 
-pNode *createPNode(char *name)
+/**
+* checkOptional()
+*
+* checkProperty, for a property that was never built. The line index is just past the
+* parameters, which is where the first value starts
+**/
+static void checkOptional(CardValidation *validation, pValue id, int valueCount, const ContentLine *contentLine)
 {
-  pNode *newNode  = malloc(sizeof(pNode));
-  newNode->name = malloc(strlen(name)+1);
-  strcpy(newNode->name, name);
-  newNode->count = 0;
+  const char *firstValue;
+  size_t index = contentLine->index;
+
+  if (validation->status != OK)//only the first error is reported
+    return;
 
-  return newNode;
+  if ((validation->status = checkPropertyRules(id, valueCount, validation->propertyCounts)) != OK || id != KIND)
+    return;
+
+  if (index < contentLine->length && contentLine->text[index] == ':')
+    index++;
+
+  firstValue = &(contentLine->text[index]);
+  index = scanFor(firstValue, contentLine->length - index, SCAN_SEMICOLON);
+
+  //the parsed value would stop at a null
+  if (sliceEqualIC(firstValue, strnlen(firstValue, index), "group"))
+    validation->kindIsGroup = true;
 }
 
-void deletePropNode(void *toDelete)
+/**
+* checkCardProperty()
+*
+* addCardProperty, keeping counts instead of building anything
+**/
+static VCardErrorCode checkCardProperty(CardCheck *check, ContentLine *contentLine, bool *endFound)
 {
-  free(((pNode*)toDelete)->name);
-  free(toDelete);
+  VCardErrorCode parseStatus = OK;
+  const char *propName;//property name, points in to the content line
+  size_t nameLength, groupLength;
+  ContentLine valueStart;//the line as it was just past the parameters
+  ParameterSlice param;
+  int valueCount;
+  pValue id;
+
+  if (findGroup(contentLine, &groupLength))//group name isn't needed, just step over it
+    contentLine->index += groupLength + 1;
+
+  if ((parseStatus = extractProp(contentLine, &propName, &nameLength)) != OK)
+    return parseStatus;
+
+  id = propertyID(propName, nameLength);
+
+  if(id == BDAY)//found bday property
+  {
+    if (check->hasBirthday)//found multiple birthday properties
+      parseStatus = INV_CARD;
+    else if ((parseStatus = checkDate(contentLine, &check->birthdayStatus)) == OK)
+      check->hasBirthday = true;
+  }
+  else if(id == ANNIVERSARY)//found Anniversary property
+  {
+    if (check->hasAnniversary)//found multiple anniversary properties
+      parseStatus = INV_CARD;
+    else if ((parseStatus = checkDate(contentLine, &check->anniversaryStatus)) == OK)
+      check->hasAnniversary = true;
+  }
+  else if (id == UNKNOWN_PROPERTY && sliceEqualIC(propName, nameLength, "END"))//found end flag
+  {
+    if (sliceEqualIC(&contentLine->text[contentLine->index], contentLine->length - contentLine->index, ":VCARD"))
+      *endFound = true;
+    else
+      parseStatus = INV_CARD;
+  }
+  else if (id == UNKNOWN_PROPERTY && sliceEqualIC(propName, nameLength, "BEGIN"))//found another begin flag
+  {
+    parseStatus = INV_CARD;
+  }
+  else if (nameLength < 1)//have standard property type, but no name
+  {
+    parseStatus = INV_PROP;
+  }
+  else
+  {
+    do//parameters are only checked, nothing is kept
+    {
+      if ((parseStatus = nextParameter(contentLine, &param)) != OK)
+        return parseStatus;
+    } while (param.found);
+
+    valueStart = *contentLine;
+    valueCount = countPropertyValues(contentLine);
+
+    if(valueCount == 0)//make sure the property had a value
+      parseStatus = INV_PROP;
+    else if (id == N && valueCount != 5)//check if name property had enough values
+      parseStatus = INV_PROP;
+    else if (id == ADR && valueCount != 7)//check if address property had enough values
+      parseStatus = INV_PROP;
+    else if (id == FN && !check->hasFn)//new FN property
+    {
+      check->hasFn = true;
+      check->fnValues = valueCount;
+    }
+    else//optional property
+    {
+      checkOptional(&check->optional, id, valueCount, &valueStart);
+    }
+  }
+
+  return parseStatus;
 }
 
-char *printPropNode(void *toPrint)
+/**
+* checkCardLine()
+*
+* addCardLine for validate-only mode. *done is set once END:VCARD has been checked
+**/
+static VCardErrorCode checkCardLine(CardCheck *check, ContentLine *contentLine, bool *done)
 {
-  return "Kevin";
+  VCardErrorCode parseStatus = OK;
+  bool endFound = false;
+
+  switch (check->stage)
+  {
+    case EXPECT_BEGIN://make sure the begin tag starts the card
+      if (!contentLine->terminated || !sliceEqualIC(contentLine->text, contentLine->length, "BEGIN:VCARD"))
+        parseStatus = INV_CARD;
+      else
+        check->stage = EXPECT_VERSION;
+      break;
+
+    case EXPECT_VERSION://make sure the vcard is version 4.0
+      if (!contentLine->terminated || !sliceEqualIC(contentLine->text, contentLine->length, "VERSION:4.0"))
+        parseStatus = INV_CARD;
+      else
+        check->stage = EXPECT_PROPERTY;
+      break;
+
+    case EXPECT_PROPERTY:
+      if ((parseStatus = checkCardProperty(check, contentLine, &endFound)) == OK && endFound)
+      {
+        if(!check->hasFn)
+          parseStatus = INV_CARD;
+        else
+          *done = true;
+      }
+      break;
+  }
+
+  return parseStatus;
 }
 
-int cmpPropNode(const void *one, const void *two)
+/**
+* checkedStatus()
+*
+* what validateCard would say about the card that was just read, in the same order
+**/
+static VCardErrorCode checkedStatus(const CardCheck *check)
 {
-  return strcmpIC(((pNode*)one)->name, ((pNode*)two)->name);
+  if (check->fnValues > 1)
+    return INV_CARD;
+
+  if (check->optional.status != OK)
+    return check->optional.status;
+
+  if (check->optional.propertyCounts[MEMBER] > 0 && !check->optional.kindIsGroup)
+    return INV_CARD;//MEMBER exists, KIND property MUST be group
+
+  if (check->hasBirthday && check->birthdayStatus != OK)
+    return check->birthdayStatus;
+
+  if (check->hasAnniversary && check->anniversaryStatus != OK)
+    return check->anniversaryStatus;
+
+  return OK;
 }
 
-bool nodeNameCmp(const void *node, const void *name)
+/**
+* checkCard()
+*
+* parseCard followed by validateCard, without building the card. Runs the same grammar
+* over the lines and keeps only counters, so the result is the same as parsing, validating
+* and deleting it. Nothing is allocated per property, only a buffer for folded lines
+**/
+VCardErrorCode checkCard(const char *vCardString, size_t maxIndex, size_t *lineIndex)
 {
-  pNode *testNode = (pNode*)node;
+  VCardErrorCode parseStatus = OK;//the current status of the parsing
+  CardCheck check;
+  LineSlice slice;//where the current content line is in vCardString
+  ContentLine contentLine;//the current content line being parsed
+  bool done = false;
+
+  if (maxIndex < 20)//too short to hold a card at all
+    return INV_FILE;
+
+  memset(&check, 0, sizeof(CardCheck));
+  check.stage = EXPECT_BEGIN;
+  check.birthdayStatus = OK;
+  check.anniversaryStatus = OK;
+  check.optional.status = OK;
+
+  while (!done)//check file unless error or the card is done
+  {
+    if ((parseStatus = nextContentLine(vCardString, maxIndex, lineIndex, &slice)) != OK)
+      break;
+
+    if (!slice.found)//hit eof before the end flag
+    {
+      parseStatus = INV_CARD;
+      break;
+    }
+
+    if ((parseStatus = openContentLineWith(vCardString, &slice, &contentLine, &check.unfolded, &check.unfoldedSize)) != OK)
+      break;
+
+    if ((parseStatus = checkCardLine(&check, &contentLine, &done)) != OK)
+      break;
+  }
+
+  free(check.unfolded);
 
-  if (strcmpIC(testNode->name, (char*)name) == 0)
-    return true;
+  if (parseStatus != OK)
+    return parseStatus;
 
-  return false;
+  return checkedStatus(&check);
 }
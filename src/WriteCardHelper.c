@@ -1,15 +1,35 @@
 /**
- * @file ParseHelper.c
+ * @file WriteCardHelper.c
  * @author Kevin ioi
  * @date Sept 2018
- * @brief File containing the helper functions used to read-in, construct and parse content
- *        lines of a vcf file (plus print, delete and compare string)
+ * @brief File containing the helper functions used to turn a card back in to vcf text. The
+ *        whole card is built up in one growable buffer, each piece copied once with its
+ *        length known, and handed to the file in a single write. Many cards are written
+ *        a batch at a time, each card in its own buffer and the batch in one writev.
+ *        Content lines are folded at 75 octets as they are appended, never afterwards
  */
 
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
 #include "VCardParser.h"
 #include "LinkedListAPI.h"
 #include "WriteCardHelper.h"
 
+#ifndef IOV_MAX
+#define IOV_MAX 16 //the least POSIX allows
+#endif
+
+//cards serialized before each writev, so a huge export never holds more than this many
+#define WRITE_BATCH 64
+
+//longest a content line may be, in octets, not counting its CRLF (RFC 6350 3.2)
+#define FOLD_LENGTH 75
+
 VCardErrorCode openFileWrite(FILE **fp, const char *fileName)
 {
   if (fileName == NULL)//no file address provided
@@ -33,143 +53,397 @@ VCardErrorCode openFileWrite(FILE **fp, const char *fileName)
 
 }
 
-VCardErrorCode writeProperty(FILE **fp, Property *writeProp)
+/**
+* startOutBuffer()
+*
+* empty buffer with room for size bytes to start with
+**/
+bool startOutBuffer(OutBuffer *out, size_t size)
 {
-  //check for validity of paramter values
-  if (writeProp == NULL || fp == NULL)
-    return WRITE_ERROR;
-  if (*fp == NULL)
-    return WRITE_ERROR;
+  out->length = 0;
+  out->size = size;
+  out->lineLength = 0;
+  out->fold = false;
 
-  char *contentLine;
-  VCardErrorCode parseStatus = OK;
+  return (out->data = malloc(size)) != NULL;
+}
 
-  if((contentLine = malloc(200)) == NULL)
-    return WRITE_ERROR;
+/**
+* freeOutBuffer()
+*
+**/
+void freeOutBuffer(OutBuffer *out)
+{
+  free(out->data);
+  out->data = NULL;
+  out->length = 0;
+  out->size = 0;
+  out->lineLength = 0;
+}
 
-  strcpy(contentLine, "");
+/**
+* reserveBytes()
+*
+* make sure length more bytes fit, doubling the buffer as needed so appending
+* stays linear in the size of the card
+**/
+bool reserveBytes(OutBuffer *out, size_t length)
+{
+  char *temp;//guard against realloc failure
+  size_t newSize = out->size == 0 ? 256 : out->size;
 
-  if (strlen(writeProp->group) > 0)
+  while (newSize - out->length < length)
+    newSize *= 2;
+
+  if (newSize != out->size)
   {
-    strcat(contentLine, writeProp->group);
-    strcat(contentLine, ".");
+    if ((temp = realloc(out->data, newSize)) == NULL)
+      return false;
+    out->data = temp;
+    out->size = newSize;
   }
 
-  strcat(contentLine, writeProp->name);
-
-  //add parameters to contentLine, if exist
-  if (getLength(writeProp->parameters) > 0)
-    parseStatus = paramListToString(&contentLine, writeProp->parameters);
-
+  return true;
+}
 
-  if (parseStatus == OK)
-    parseStatus = propListToString(&contentLine, writeProp->values);
+/**
+* foldPoint()
+*
+* how much of bytes fits in room octets without splitting a UTF-8 sequence. Only backs off
+* over the three continuation bytes a real sequence can have, so bad UTF-8 is still cut
+**/
+static size_t foldPoint(const char *bytes, size_t room)
+{
+  size_t take = room;
 
-  if (parseStatus == OK)
-    fprintf(*fp, "%s\r\n", contentLine);
+  while (take > 0 && room - take < 3 && ((unsigned char)bytes[take] & 0xC0) == 0x80)//10xxxxxx continues a sequence
+    take--;
 
-  free(contentLine);
+  if (((unsigned char)bytes[take] & 0xC0) == 0x80)//not UTF-8 at all
+    return room;
 
-  return parseStatus;
+  return take;
 }
 
-
-VCardErrorCode propListToString(char **contentLine, List *values)
+/**
+* appendFolded()
+*
+* copy bytes on to the current content line, starting a CRLF + space continuation each
+* time the line reaches FOLD_LENGTH. The fold points come from lineLength, nothing that is
+* already in the buffer is looked at again
+**/
+static bool appendFolded(OutBuffer *out, const char *bytes, size_t length)
 {
-  ListIterator iter = createIterator(values);
-  char *tempValue;
+  size_t room, take;
 
-  strcat(*contentLine, ":");
+  //each continuation holds at least FOLD_LENGTH - 4 bytes, so this is enough room for every fold
+  if (!reserveBytes(out, length + 3 * (length / (FOLD_LENGTH - 4) + 2)))
+    return false;
 
-  while ((tempValue = (char*)nextElement(&iter)) != NULL)
+  while (length > FOLD_LENGTH - out->lineLength)
   {
-    strcat(*contentLine, tempValue);
-    strcat(*contentLine, ";");
+    room = FOLD_LENGTH - out->lineLength;
+    take = foldPoint(bytes, room);
+
+    memcpy(&(out->data[out->length]), bytes, take);
+    memcpy(&(out->data[out->length + take]), "\r\n ", 3);
+    out->length += take + 3;
+    out->lineLength = 1;//the space
+    bytes += take;
+    length -= take;
   }
 
-  (*contentLine)[strlen(*contentLine) - 1] = '\0';//remove last semicolon
+  memcpy(&(out->data[out->length]), bytes, length);
+  out->length += length;
+  out->lineLength += length;
 
-  return OK;
+  return true;
+}
+
+/**
+* appendBytes()
+*
+* add bytes to the current content line, folding it if the buffer folds
+**/
+bool appendBytes(OutBuffer *out, const char *bytes, size_t length)
+{
+  if (out->fold)
+    return appendFolded(out, bytes, length);
+
+  if (!reserveBytes(out, length))
+    return false;
+
+  memcpy(&(out->data[out->length]), bytes, length);
+  out->length += length;
+
+  return true;
+}
+
+/**
+* appendString()
+*
+**/
+bool appendString(OutBuffer *out, const char *string)
+{
+  return appendBytes(out, string, strlen(string));
+}
+
+/**
+* endLine()
+*
+* CRLF that ends a content line, the next append starts a fresh line
+**/
+bool endLine(OutBuffer *out)
+{
+  if (!reserveBytes(out, 2))
+    return false;
+
+  memcpy(&(out->data[out->length]), "\r\n", 2);
+  out->length += 2;
+  out->lineLength = 0;
+
+  return true;
 }
 
-VCardErrorCode paramListToString(char **contentLine, List *parameters)
+/**
+* writeProperty()
+*
+* append one GROUP.NAME;PARAM=VALUE:VALUE;VALUE content line. A property with no values
+* gets no colon either
+**/
+VCardErrorCode writeProperty(OutBuffer *out, const Property *writeProp)
 {
-  ListIterator iter = createIterator(parameters);
+  ListIterator iter;
   Parameter *tempParam;
+  char *tempValue;
+  bool ok = true, firstValue = true;
+
+  //check for validity of paramter values
+  if (writeProp == NULL || out == NULL)
+    return WRITE_ERROR;
 
-  while ((tempParam = (Parameter*)nextElement(&iter)) != NULL)
+  if (strlen(writeProp->group) > 0)
+    ok = appendString(out, writeProp->group) && appendBytes(out, ".", 1);
+
+  ok = ok && appendString(out, writeProp->name);
+
+  //add parameters to contentLine, if exist
+  iter = createIterator(writeProp->parameters);
+  while (ok && (tempParam = (Parameter*)nextElement(&iter)) != NULL)
   {
-    strcat(*contentLine, ";");
-    strcat(*contentLine, tempParam->name);
-    strcat(*contentLine, "=");
-    strcat(*contentLine, tempParam->value);
+    ok = appendBytes(out, ";", 1) && appendString(out, tempParam->name) &&
+         appendBytes(out, "=", 1) && appendString(out, tempParam->value);
   }
 
-  return OK;
+  iter = createIterator(writeProp->values);
+  while (ok && (tempValue = (char*)nextElement(&iter)) != NULL)
+  {
+    ok = appendBytes(out, firstValue ? ":" : ";", 1) && appendString(out, tempValue);
+    firstValue = false;
+  }
+
+  ok = ok && endLine(out);
+
+  return ok ? OK : WRITE_ERROR;
 }
 
-VCardErrorCode writeOptionalProps(FILE **fp, List *props)
+/**
+* writeOptionalProps()
+*
+* append every property in props
+**/
+VCardErrorCode writeOptionalProps(OutBuffer *out, List *props)
 {
-  if (fp == NULL || props == NULL)
-    return WRITE_ERROR;
-  if (*fp == NULL)
+  Property *tempProp;
+  ListIterator iter;
+
+  if (out == NULL || props == NULL)
     return WRITE_ERROR;
 
-  VCardErrorCode parseStatus;
-  Property *tempProp;
-  ListIterator iter = createIterator(props);
+  iter = createIterator(props);
 
   while ((tempProp = (Property*)nextElement(&iter)) != NULL)
   {
-    if((parseStatus = writeProperty(fp, tempProp))!= OK)
-      return parseStatus;
+    if (writeProperty(out, tempProp) != OK)
+      return WRITE_ERROR;
   }
 
   return OK;
 }
 
-VCardErrorCode writeDateTime(char **contentLine, DateTime *writeDate)
+/**
+* writeDateTime()
+*
+* append a BDAY or ANNIVERSARY line. A date with nothing in it is written as the bare name
+**/
+VCardErrorCode writeDateTime(OutBuffer *out, const char *name, const DateTime *writeDate)
 {
+  bool ok;
+
   if (writeDate == NULL)
   {
      return OK;
   }
 
+  ok = appendString(out, name);
+
   if (writeDate->isText == 1)
   {
-    strcat(*contentLine, ";Value=Text:");
-    strcat(*contentLine, writeDate->text);
+    ok = ok && appendString(out, ";Value=Text:") && appendString(out, writeDate->text);
   }
   else if(strlen(writeDate->date)>0)
   {
-    strcat(*contentLine, ":");
-    strcat(*contentLine, writeDate->date);
+    ok = ok && appendBytes(out, ":", 1) && appendString(out, writeDate->date);
 
     if (strlen(writeDate->time)>0)
-    {
-      strcat(*contentLine, "T");
-      strcat(*contentLine, writeDate->time);
-    }
+      ok = ok && appendBytes(out, "T", 1) && appendString(out, writeDate->time);
 
     if (writeDate->UTC == 1)
-    {
-      strcat(*contentLine, "Z");
-    }
+      ok = ok && appendBytes(out, "Z", 1);
   }
   else if (strlen(writeDate->time)>0)
   {
-    strcat(*contentLine, ":");
-    strcat(*contentLine, "T");
-    strcat(*contentLine, writeDate->time);
+    ok = ok && appendBytes(out, ":T", 2) && appendString(out, writeDate->time);
+
     if (writeDate->UTC == 1)
+      ok = ok && appendBytes(out, "Z", 1);
+  }
+
+  ok = ok && endLine(out);
+
+  return ok ? OK : WRITE_ERROR;
+}
+
+/**
+* writeCardTo()
+*
+* append the whole card, BEGIN:VCARD to END:VCARD, to out, with long lines folded. Only a
+* missing card or fn, or running out of memory, is an error
+**/
+VCardErrorCode writeCardTo(OutBuffer *out, const Card *obj)
+{
+  VCardErrorCode parseStatus;
+
+  if (obj == NULL)//no card provided
+    return WRITE_ERROR;
+
+  out->fold = true;
+  out->lineLength = 0;
+
+  if (!(appendString(out, "BEGIN:VCARD") && endLine(out) && appendString(out, "VERSION:4.0") && endLine(out)))//hardcoded header for vCard
+    return WRITE_ERROR;
+
+  if((parseStatus = writeProperty(out, obj->fn))!= OK)
+    return parseStatus;
+
+  if (obj->optionalProperties != NULL && (parseStatus = writeOptionalProps(out, obj->optionalProperties)) != OK)
+    return parseStatus;
+
+  if ((parseStatus = writeDateTime(out, "ANNIVERSARY", obj->anniversary)) != OK)
+    return parseStatus;
+
+  if ((parseStatus = writeDateTime(out, "BDAY", obj->birthday)) != OK)
+    return parseStatus;
+
+  if (!(appendString(out, "END:VCARD") && endLine(out)))
+    return WRITE_ERROR;
+
+  return OK;
+}
+
+/**
+* writeVectors()
+*
+* writev every byte of vectors to fd, picking up where a short write left off
+**/
+static VCardErrorCode writeVectors(int fd, struct iovec *vectors, int count)
+{
+  ssize_t written;
+
+  while (count > 0)
+  {
+    if ((written = writev(fd, vectors, count > IOV_MAX ? IOV_MAX : count)) < 0)
     {
-      strcat(*contentLine, "Z");
+      if (errno == EINTR)
+        continue;
+      return WRITE_ERROR;
+    }
+
+    if (written == 0)//nothing can be written, give up instead of spinning
+      return WRITE_ERROR;
+
+    while (count > 0 && (size_t)written >= vectors->iov_len)//drop what went out whole
+    {
+      written -= vectors->iov_len;
+      vectors++;
+      count--;
+    }
+
+    if (count > 0)//part of the next one went out too
+    {
+      vectors->iov_base = (char*)vectors->iov_base + written;
+      vectors->iov_len -= written;
     }
   }
-  else
+
+  return OK;
+}
+
+/**
+* flushOutBuffer()
+*
+* write everything in out to fd and empty it, its memory is kept for what comes next
+**/
+VCardErrorCode flushOutBuffer(int fd, OutBuffer *out)
+{
+  struct iovec vector;
+  VCardErrorCode parseStatus = OK;
+
+  if (out->length > 0)
   {
-    return WRITE_ERROR;
+    vector.iov_base = out->data;
+    vector.iov_len = out->length;
+    parseStatus = writeVectors(fd, &vector, 1);
   }
 
-  return OK;
+  out->length = 0;
+  out->lineLength = 0;
+
+  return parseStatus;
+}
+
+/**
+* writeCardBatch()
+*
+* write cardCount cards to fd one after another, WRITE_BATCH at a time. The buffers of one
+* batch are reused for the next
+**/
+VCardErrorCode writeCardBatch(int fd, Card **cards, size_t cardCount)
+{
+  VCardErrorCode parseStatus = OK;
+  OutBuffer buffers[WRITE_BATCH] = {{0}};
+  struct iovec vectors[WRITE_BATCH];
+  size_t i, j, batch;
+
+  for (i = 0; i < cardCount && parseStatus == OK; i += batch)
+  {
+    batch = cardCount - i < WRITE_BATCH ? cardCount - i : WRITE_BATCH;
+
+    for (j = 0; j < batch && parseStatus == OK; j++)
+    {
+      buffers[j].length = 0;
+      parseStatus = writeCardTo(&buffers[j], cards[i+j]);
+
+      vectors[j].iov_base = buffers[j].data;
+      vectors[j].iov_len = buffers[j].length;
+    }
+
+    if (parseStatus == OK)
+      parseStatus = writeVectors(fd, vectors, batch);
+  }
+
+  for (j = 0; j < WRITE_BATCH; j++)
+    freeOutBuffer(&buffers[j]);
+
+  return parseStatus;
 }
@@ -0,0 +1,399 @@
+/**
+ * @file tester.c
+ * @author Kevin ioi
+ * @date Oct 2018
+ * @brief Regression tests for the parser, run with make test. Each test builds its vcf
+ *        text in memory and prints PASS or FAIL, the exit status is the number of failures
+ */
+
+#include "VCardParser.h"
+#include "LinkedListAPI.h"
+#include "ParallelHelper.h"
+
+//the first card has no END:VCARD, so it runs in to the BEGIN:VCARD of the second
+#define TRUNCATED_THEN_TWO \
+  "BEGIN:VCARD\r\nVERSION:4.0\r\nFN:A\r\n" \
+  "BEGIN:VCARD\r\nVERSION:4.0\r\nFN:B\r\nEND:VCARD\r\n" \
+  "BEGIN:VCARD\r\nVERSION:4.0\r\nFN:C\r\nEND:VCARD\r\n"
+
+/**
+* cardName()
+*
+* the FN value of card, "" if there isn't one
+**/
+static const char *cardName(const Card *card)
+{
+  if (card == NULL || card->fn == NULL || getLength(card->fn->values) == 0)
+    return "";
+
+  return (const char*)getFromFront(card->fn->values);
+}
+
+/**
+* addName()
+*
+* append card's FN and a comma to names, - for a card that was invalid
+**/
+static bool addName(char **names, size_t *used, size_t *size, const Card *card)
+{
+  const char *name = card == NULL ? "-" : cardName(card);
+  size_t length = strlen(name);
+  char *temp;//guard against realloc failure
+
+  if (*used + length + 2 > *size)
+  {
+    *size = (*used + length + 2) * 2;
+    if ((temp = realloc(*names, *size)) == NULL)
+      return false;
+    *names = temp;
+  }
+
+  memcpy(&(*names)[*used], name, length);
+  *used += length;
+  (*names)[(*used)++] = ',';
+  (*names)[*used] = '\0';
+
+  return true;
+}
+
+/**
+* streamNames()
+*
+* walk text with nextCard, listing each card's FN (or - for an invalid card). NULL if
+* memory ran out
+**/
+static char *streamNames(const char *text)
+{
+  CardStream *stream;
+  Card *card;
+  VCardErrorCode parseStatus;
+  char *names = calloc(1, 1);
+  size_t used = 0, size = 1;
+  bool ok = names != NULL;
+
+  if (!ok || openCardStreamFromBuffer(text, strlen(text), &stream) != OK)
+  {
+    free(names);
+    return NULL;
+  }
+
+  while (ok && ((parseStatus = nextCard(stream, &card)) != OK || card != NULL))
+  {
+    ok = addName(&names, &used, &size, parseStatus == OK ? card : NULL);
+    deleteCard(card);
+  }
+
+  closeCardStream(stream);
+
+  if (!ok)
+  {
+    free(names);
+    return NULL;
+  }
+
+  return names;
+}
+
+/**
+* parallelNames()
+*
+* the same list as streamNames, from parseCardsParallel on threadCount threads
+**/
+static char *parallelNames(const char *text, int threadCount)
+{
+  Card **cards;
+  size_t cardCount, i;
+  char *names = calloc(1, 1);
+  size_t used = 0, size = 1;
+  bool ok = names != NULL;
+
+  if (!ok || parseCardsParallel(text, strlen(text), threadCount, &cards, &cardCount) == OTHER_ERROR)
+  {
+    free(names);
+    return NULL;
+  }
+
+  for (i = 0; ok && i < cardCount; i++)
+    ok = addName(&names, &used, &size, cards[i]);
+
+  deleteCards(cards, cardCount);
+
+  if (!ok)
+  {
+    free(names);
+    return NULL;
+  }
+
+  return names;
+}
+
+/*
+  Names of the cards a push parser has handed over so far
+*/
+typedef struct pushedNames {
+  char    *names;
+  size_t  used;
+  size_t  size;
+  bool    ok;
+} PushedNames;
+
+/**
+* onPushedCard()
+*
+**/
+static void onPushedCard(Card *card, void *context)
+{
+  PushedNames *pushed = (PushedNames*)context;
+
+  pushed->ok = pushed->ok && addName(&pushed->names, &pushed->used, &pushed->size, card);
+  deleteCard(card);
+}
+
+/**
+* pushNames()
+*
+* feed text to a push parser step bytes at a time, listing the cards it hands over. Invalid
+* cards aren't handed over, so they don't appear. *firstError is the first error reported
+**/
+static char *pushNames(const char *text, size_t step, VCardErrorCode *firstError)
+{
+  PushedNames pushed = { calloc(1, 1), 0, 1, true };
+  VCardPushParser *parser;
+  VCardErrorCode parseStatus;
+  size_t length = strlen(text), i;
+
+  *firstError = OK;
+  if (pushed.names == NULL || vcardParserOpen(onPushedCard, &pushed, &parser) != OK)
+  {
+    free(pushed.names);
+    return NULL;
+  }
+
+  for (i = 0; i < length; i += step)
+  {
+    parseStatus = vcardParserFeed(parser, &text[i], length - i < step ? length - i : step);
+    if (*firstError == OK)
+      *firstError = parseStatus;
+  }
+
+  parseStatus = vcardParserFinish(parser);
+  if (*firstError == OK)
+    *firstError = parseStatus;
+
+  vcardParserClose(parser);
+
+  if (!pushed.ok)
+  {
+    free(pushed.names);
+    return NULL;
+  }
+
+  return pushed.names;
+}
+
+/**
+* withoutInvalid()
+*
+* names with the - entries of invalid cards taken out, in place
+**/
+static char *withoutInvalid(char *names)
+{
+  char *from = names, *to = names;
+
+  while (names != NULL && *from != '\0')
+  {
+    if (from[0] == '-' && from[1] == ',')
+      from += 2;
+    else
+      *to++ = *from++;
+  }
+
+  if (names != NULL)
+    *to = '\0';
+
+  return names;
+}
+
+/**
+* namesAre()
+*
+* true if names isn't NULL and is expected, frees names either way
+**/
+static bool namesAre(char *names, const char *expected)
+{
+  bool same = names != NULL && strcmp(names, expected) == 0;
+
+  free(names);
+
+  return same;
+}
+
+/**
+* truncatedCards()
+*
+* groups of a card with no END:VCARD followed by two good ones, at least minLength long,
+* so the parallel parser splits it in to several chunks
+**/
+static char *truncatedCards(size_t minLength)
+{
+  const char *group = "BEGIN:VCARD\r\nVERSION:4.0\r\nFN:A%zu\r\nNOTE:no end\r\n"
+                      "BEGIN:VCARD\r\nVERSION:4.0\r\nFN:B%zu\r\nEND:VCARD\r\n"
+                      "BEGIN:VCARD\r\nVERSION:4.0\r\nFN:C%zu\r\nEND:VCARD\r\n";
+  size_t size = minLength + 256, used = 0, i;
+  char *text = malloc(size);
+
+  for (i = 0; text != NULL && used < minLength; i++)
+    used += snprintf(&text[used], size - used, group, i, i, i);
+
+  return text;
+}
+
+/**
+* testStreamAfterTruncatedCard()
+*
+* a card with no END:VCARD fails, but the card whose BEGIN:VCARD cut it short is still read
+**/
+static bool testStreamAfterTruncatedCard(void)
+{
+  return namesAre(streamNames(TRUNCATED_THEN_TWO), "-,B,C,");
+}
+
+/**
+* testStreamTrailingBlankLines()
+*
+* blank lines after the last card are not another card
+**/
+static bool testStreamTrailingBlankLines(void)
+{
+  return namesAre(streamNames("BEGIN:VCARD\r\nVERSION:4.0\r\nFN:A\r\nEND:VCARD\r\n\r\n \t\r\n"), "A,");
+}
+
+/**
+* testParallelMatchesStream()
+*
+* however many threads split the file, and wherever the chunks are cut, the cards come out
+* the same as from nextCard
+**/
+static bool testParallelMatchesStream(void)
+{
+  char *text = truncatedCards(2 * 1024 * 1024), *expected;
+  bool same;
+  int threadCount;
+
+  if (text == NULL || (expected = streamNames(text)) == NULL)
+  {
+    free(text);
+    return false;
+  }
+
+  same = namesAre(parallelNames(TRUNCATED_THEN_TWO, 2), "-,B,C,");
+  for (threadCount = 1; same && threadCount <= 7; threadCount++)
+    same = namesAre(parallelNames(text, threadCount), expected);
+
+  free(expected);
+  free(text);
+
+  return same;
+}
+
+/**
+* testPushAfterTruncatedCard()
+*
+* the push parser reports the card with no END:VCARD but still builds the one that cut it
+* short, however the bytes are split up
+**/
+static bool testPushAfterTruncatedCard(void)
+{
+  VCardErrorCode firstError;
+  size_t step;
+  bool same = true;
+
+  for (step = 1; same && step <= strlen(TRUNCATED_THEN_TWO); step++)
+    same = namesAre(pushNames(TRUNCATED_THEN_TWO, step, &firstError), "B,C,") && firstError == INV_CARD;
+
+  return same;
+}
+
+/**
+* testPushMatchesStream()
+*
+* the push parser hands over the same cards that nextCard returns
+**/
+static bool testPushMatchesStream(void)
+{
+  char *text = truncatedCards(256 * 1024), *expected;
+  VCardErrorCode firstError;
+  bool same;
+
+  if (text == NULL || (expected = withoutInvalid(streamNames(text))) == NULL)
+  {
+    free(text);
+    return false;
+  }
+
+  same = namesAre(pushNames(text, 4093, &firstError), expected) && firstError == INV_CARD;
+
+  free(expected);
+  free(text);
+
+  return same;
+}
+
+/**
+* testParameterCase()
+*
+* properties whose parameters differ only in case are different properties, even though
+* compareParameters alone calls the parameters equal
+**/
+static bool testParameterCase(void)
+{
+  const char *text = "BEGIN:VCARD\r\nVERSION:4.0\r\nFN:A\r\n"
+                     "TEL;TYPE=work:1\r\nTEL;TYPE=WORK:1\r\nEND:VCARD\r\n";
+  CardStream *stream;
+  Card *card = NULL;
+  Property *one, *two;
+  bool passed;
+
+  if (openCardStreamFromBuffer(text, strlen(text), &stream) != OK)
+    return false;
+
+  passed = nextCard(stream, &card) == OK && card != NULL && getLength(card->optionalProperties) == 2;
+  closeCardStream(stream);
+
+  if (passed)
+  {
+    one = (Property*)getFromFront(card->optionalProperties);
+    two = (Property*)getFromBack(card->optionalProperties);
+    passed = compareProperties(one, two) != 0 && compareProperties(one, one) == 0 &&
+             compareParameters(getFromFront(one->parameters), getFromFront(two->parameters)) == 0;
+  }
+
+  deleteCard(card);
+
+  return passed;
+}
+
+int main(void)
+{
+  struct { const char *name; bool (*run)(void); } tests[] = {
+    {"stream after truncated card", testStreamAfterTruncatedCard},
+    {"stream trailing blank lines", testStreamTrailingBlankLines},
+    {"parallel matches stream", testParallelMatchesStream},
+    {"push after truncated card", testPushAfterTruncatedCard},
+    {"push matches stream", testPushMatchesStream},
+    {"parameter case", testParameterCase},
+  };
+  size_t i;
+  int failures = 0;
+
+  for (i = 0; i < sizeof(tests) / sizeof(tests[0]); i++)
+  {
+    bool passed = tests[i].run();
+
+    printf("%s: %s\n", passed ? "PASS" : "FAIL", tests[i].name);
+    if (!passed)
+      failures++;
+  }
+
+  return failures;
+}